@@ -0,0 +1,80 @@
+#!/bin/bash
+# runs a scripted session of the server mode:
+#   ./runserver.sh [path/to/2ls]
+# check, summary, a reload after changing main only
+# (the state of foo must be kept), check again, quit
+
+SUMMARIZER=${1:-../../src/summarizer/2ls}
+
+DIR=`mktemp -d`
+trap "rm -rf $DIR" EXIT
+
+write_program()
+{
+  cat > $DIR/main.c <<EOF
+int foo(int x)
+{
+  if(x<0) x=0;
+  return x;
+}
+
+int main()
+{
+  int x;
+  int y=foo(x);
+  assert(y>=$1);
+  return 0;
+}
+EOF
+}
+
+# sends a query and prints the response, which ends with
+# a closing brace in the first column
+query()
+{
+  echo "$1" >&${SERVER[1]}
+  RESPONSE=""
+  while IFS= read -r -t 60 LINE <&${SERVER[0]}
+  do
+    RESPONSE="$RESPONSE$LINE"
+    [ "$LINE" == "}" ] && break
+  done
+  echo "$1:" "$RESPONSE"
+}
+
+FAILED=0
+expect()
+{
+  if ! echo "$RESPONSE" | grep -q "$1"; then
+    echo "MISSING: $1"
+    FAILED=1
+  fi
+}
+
+write_program 0
+coproc SERVER { $SUMMARIZER --server $DIR/main.c 2>&1; }
+
+query "check"
+expect '"result": *"PASS"'
+query "summary foo"
+expect '"status": *"ok"'
+SUMMARY_BEFORE=`echo "$RESPONSE" | sed -n 's/.*"summary": *\("[^"]*"\).*/\1/p'`
+
+write_program 1
+query "reload"
+expect '"status": *"ok"'
+expect '"kept": *[1-9]'
+
+query "check"
+expect '"result": *"FAIL"'
+query "summary foo"
+SUMMARY_AFTER=`echo "$RESPONSE" | sed -n 's/.*"summary": *\("[^"]*"\).*/\1/p'`
+if [ -z "$SUMMARY_BEFORE" ] || [ "$SUMMARY_BEFORE" != "$SUMMARY_AFTER" ]; then
+  echo "SUMMARY OF foo CHANGED"
+  FAILED=1
+fi
+
+echo "quit" >&${SERVER[1]}
+wait $SERVER_PID
+
+exit $FAILED
@@ -0,0 +1,14 @@
+void main()
+{
+  int x = 0, y = 0, c;
+
+  while(x<10)
+  {
+    c = 5;
+    x++;
+    y++;
+  }
+
+  assert(x==y);
+  assert(x<=10);
+}
@@ -0,0 +1,45 @@
+#!/bin/bash
+# checks the compact Horn-clause encoding of the horn* tests
+# against the verdict of the analysis and compares its size
+# with the plain encoding:
+#   ./runhorn.sh [path/to/2ls] [path/to/z3]
+# the clauses of a safe program are satisfiable, those of an
+# unsafe program are not
+
+SUMMARIZER=${1:-../../src/summarizer/2ls}
+Z3=${2:-z3}
+
+FAILED=0
+for d in horn*/
+do
+  d=${d%/}
+  [ -f $d/main.c ] || continue
+
+  $SUMMARIZER $d/main.c > /dev/null 2>&1
+  case $? in
+    0) EXPECTED=sat ;;
+    10) EXPECTED=unsat ;;
+    *) EXPECTED=unknown ;;
+  esac
+
+  $SUMMARIZER $d/main.c --horn-encoding $d/compact.smt2 --horn-compact \
+    > /dev/null 2>&1
+  $SUMMARIZER $d/main.c --horn-encoding $d/plain.smt2 > /dev/null 2>&1
+
+  RESULT=`(echo "(set-logic HORN)"; cat $d/compact.smt2; echo "(check-sat)") | \
+    $Z3 -in -smt2 2>&1 | tail -n 1`
+
+  echo $d: "analysis" $EXPECTED, "compact encoding" $RESULT, \
+    "predicates" `grep -c "^(declare-fun" $d/compact.smt2` \
+    "of" `grep -c "^(declare-fun" $d/plain.smt2`, \
+    "clauses" `grep -c "^(assert" $d/compact.smt2` \
+    "of" `grep -c "^(assert" $d/plain.smt2`
+
+  if [ "$EXPECTED" != unknown ] && [ "$RESULT" != "$EXPECTED" ]; then
+    echo $d: "MISMATCH"
+    FAILED=1
+  fi
+  rm -f $d/compact.smt2 $d/plain.smt2
+done
+
+exit $FAILED
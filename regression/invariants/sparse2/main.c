@@ -0,0 +1,18 @@
+#include <assert.h>
+
+void main()
+{
+  int x = 0;
+  unsigned y = 0;
+  unsigned u = 0;
+  
+  while(x<10 && y<20)
+  {
+    ++x;
+    ++y;
+    u+=2;
+  }
+  
+  int z=x+y;
+  assert(z<=20);
+}
@@ -0,0 +1,11 @@
+void main()
+{
+  int x = 0;
+
+  while(x<10)
+  {
+    x++;
+    assert(x<=10);
+    assert(x!=5);
+  }
+}
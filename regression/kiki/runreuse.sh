@@ -0,0 +1,41 @@
+#!/bin/bash
+# compares the number of strategy iterations of k-induction
+# with and without --reuse-invariants on the tests of this suite:
+#   ./runreuse.sh [path/to/2ls]
+# fails if reusing the invariants takes more iterations
+
+SUMMARIZER=${1:-../../src/summarizer/2ls}
+CHECKS="--k-induction"
+
+TIMEOUT=1800
+
+iterations()
+{
+  perl -e 'alarm shift @ARGV; exec @ARGV' $TIMEOUT $SUMMARIZER $CHECKS "$@" \
+    2>&1 | sed -n 's/^  number of strategy iterations: //p'
+}
+
+FAILED=0
+TOTAL_WITHOUT=0
+TOTAL_WITH=0
+for d in */
+do
+  d=${d%/}
+  [ -f $d/main.c ] || continue
+  WITHOUT=`iterations $d/main.c`
+  WITH=`iterations $d/main.c --reuse-invariants`
+  if [ -z "$WITHOUT" ] || [ -z "$WITH" ]; then
+    echo $d: "no statistics"
+    continue
+  fi
+  echo $d: $WITHOUT "without," $WITH "with reuse"
+  TOTAL_WITHOUT=$((TOTAL_WITHOUT+WITHOUT))
+  TOTAL_WITH=$((TOTAL_WITH+WITH))
+  if [ $WITH -gt $WITHOUT ]; then
+    echo $d: "MORE ITERATIONS"
+    FAILED=1
+  fi
+done
+
+echo "total:" $TOTAL_WITHOUT "without," $TOTAL_WITH "with reuse"
+exit $FAILED
@@ -0,0 +1,11 @@
+void main()
+{
+  int x = 0;
+
+  while(x<100)
+  {
+    ++x;
+  }
+
+  assert(x==100);
+}
@@ -0,0 +1,40 @@
+#!/bin/bash
+# compares the run times of two builds of 2ls on this suite,
+# e.g. before and after a change:
+#   ./runverbosity.sh /path/to/old/2ls ../../src/summarizer/2ls
+# each build is run at the default verbosity and with --verbosity 10
+
+BEFORE=${1:-../../src/summarizer/2ls}
+AFTER=${2:-../../src/summarizer/2ls}
+CHECKS="--termination"
+
+TIMEOUT=1800
+
+for b in before after
+do
+  if [ $b = before ]; then SUMMARIZER=$BEFORE; else SUMMARIZER=$AFTER; fi
+  for v in default 10
+  do
+    if [ $v = default ]; then VERBOSITY=""; else VERBOSITY="--verbosity $v"; fi
+    LOG=verbosity.$b.$v.log
+    rm -f $LOG
+    for d in */
+    do 
+      d=${d%/}
+      [ -f $d/main.c ] || continue
+      echo $d "using" $b "at verbosity" $v
+      echo "TEST:" $d >> $LOG
+      (TIMEFORMAT=%R; time (perl -e 'alarm shift @ARGV; exec @ARGV' $TIMEOUT $SUMMARIZER $CHECKS $VERBOSITY $d/main.c > /dev/null)) 2>> $LOG
+    done
+  done
+done
+
+# total wall-clock seconds per build and verbosity
+for b in before after
+do
+  for v in default 10
+  do
+    echo $b "at verbosity" $v: \
+      `grep -v "^TEST:" verbosity.$b.$v.log | awk '{ s+=$1 } END { printf "%.2f s", s }'`
+  done
+done
@@ -107,7 +107,14 @@ void ssa_fixed_pointt::do_backwards_edge(
 {
   assert(from->is_backwards_goto());
   
-  //locationt to=from->get_target();
+  locationt to=from->get_target();
+
+  // the back edge is taken from 'from' to the loop head 'to'
+  exprt pre_guard=
+    and_exprt(SSA.guard_symbol(to),
+              SSA.name(SSA.guard_symbol(), local_SSAt::LOOP_SELECT, from));
+  exprt post_guard=
+    and_exprt(SSA.guard_symbol(from), SSA.cond_symbol(from));
 
   // Record the objects modified by the loop to get
   // 'primed' (post-state) and 'unprimed' (pre-state) variables.
@@ -121,11 +128,15 @@ void ssa_fixed_pointt::do_backwards_edge(
   
     fixed_point.pre_state_vars.push_back(in);
     fixed_point.post_state_vars.push_back(out);
+    fixed_point.pre_guards.push_back(pre_guard);
+    fixed_point.post_guards.push_back(post_guard);
   }
 
   ssa_objectt guard=SSA.guard_symbol();
   fixed_point.pre_state_vars.push_back(SSA.name(guard, local_SSAt::LOOP_BACK, from));
   fixed_point.post_state_vars.push_back(SSA.name(guard, local_SSAt::OUT, from));
+  fixed_point.pre_guards.push_back(pre_guard);
+  fixed_point.post_guards.push_back(post_guard);
 }
 
 /*******************************************************************\
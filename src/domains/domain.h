@@ -16,6 +16,9 @@ public:
   domain_number(_domain_number), renaming_map(_renaming_map) {}
   virtual ~domaint() {}
 
+  void set_domain_number(unsigned _domain_number)
+    { domain_number = _domain_number; }
+
   typedef exprt vart;
   typedef std::vector<vart> var_listt;
   typedef std::set<vart> var_sett;
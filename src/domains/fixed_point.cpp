@@ -6,9 +6,13 @@ Author: Daniel Kroening, kroening@kroening.com
 
 \*******************************************************************/
 
-#define DEBUG
+#include <langapi/language_util.h>
 
 #include "fixed_point.h"
+#include "equality_domain.h"
+#include "tpolyhedra_domain.h"
+#include "strategy_solver_equality.h"
+#include "strategy_solver_binsearch.h"
 
 #ifdef DEBUG
 #include <iostream>
@@ -22,104 +26,194 @@ Function: fixed_pointt::operator()
 
  Outputs:
 
- Purpose:
+ Purpose: The transition relation is loaded into the solver once.
+          The strategy solvers only add and retract the constraints
+          for the current state predicate in each iteration.
 
 \*******************************************************************/
 
 void fixed_pointt::operator()()
 {
   iteration_number=0;
-  
+
   // Set up the state predicate, starting with 'false'
   // (the empty set).
 
-  state_predicate.state_vars=pre_state_vars;
-  state_predicate.make_false();
-  
+  state_predicate=false_exprt();
+
+  incremental_solvert solver(ns);
+
+  for(constraintst::const_iterator
+      it=transition_relation.begin();
+      it!=transition_relation.end();
+      it++)
+    solver << *it;
+
+  domaint::var_specst var_specs;
+  replace_mapt renaming_map;
+  get_var_specs(var_specs, renaming_map);
+
+  exprt::operandst invariants;
+
+  if(use_equalities)
+  {
+    exprt inv=equalities(solver, var_specs, renaming_map);
+    invariants.push_back(inv);
+
+    // the invariant is inductive: use it to strengthen the next domain
+    solver << inv;
+  }
+
+  if(use_intervals)
+    invariants.push_back(intervals(solver, var_specs, renaming_map));
+
+  state_predicate=conjunction(invariants);
+
+  #ifdef DEBUG
+  std::cout << "Fixed-point after " << iteration_number
+            << " iteration(s)\n";
+  output(std::cout);
+  #endif
+}
+
+/*******************************************************************\
+
+Function: fixed_pointt::get_var_specs
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: the template is over the pre-state variables,
+          the renaming map gives the corresponding post-state
+
+\*******************************************************************/
+
+void fixed_pointt::get_var_specs(
+  domaint::var_specst &var_specs,
+  replace_mapt &renaming_map) const
+{
+  assert(pre_state_vars.size()==post_state_vars.size());
+
+  for(unsigned i=0; i<pre_state_vars.size(); i++)
+  {
+    var_specs.push_back(domaint::var_spect());
+    domaint::var_spect &var_spec=var_specs.back();
+    var_spec.var=pre_state_vars[i];
+    var_spec.pre_guard=
+      i<pre_guards.size() ? pre_guards[i] : exprt(true_exprt());
+    var_spec.post_guard=
+      i<post_guards.size() ? post_guards[i] : exprt(true_exprt());
+    var_spec.aux_expr=true_exprt();
+    var_spec.kind=domaint::LOOP;
+
+    renaming_map[pre_state_vars[i]]=post_state_vars[i];
+  }
+}
+
+/*******************************************************************\
+
+Function: fixed_pointt::equalities
+
+  Inputs:
+
+ Outputs: the invariant over the pre-state variables
+
+ Purpose:
+
+\*******************************************************************/
+
+exprt fixed_pointt::equalities(
+  incremental_solvert &solver,
+  const domaint::var_specst &var_specs,
+  replace_mapt &renaming_map)
+{
+  equality_domaint domain(0, renaming_map, var_specs, ns);
+  strategy_solver_equalityt strategy_solver(domain, solver, ns);
+
+  equality_domaint::equ_valuet inv;
+  domain.initialize(inv);
+
   bool change;
 
   do
   {
     iteration_number++;
-    
+
     #ifdef DEBUG
     std::cout << "\n"
               << "******** Forward least fixed-point iteration #"
-              << iteration_number << "\n";
+              << iteration_number << " (equalities)\n";
     #endif
-   
-    change=iteration();
+
+    change=strategy_solver.iterate(inv);
   }
   while(change);
 
-  #ifdef DEBUG
-  std::cout << "Fixed-point after " << iteration_number
-            << " iteration(s)\n";
-  output(std::cout);
-  #endif
+  domaint::var_sett vars(pre_state_vars.begin(), pre_state_vars.end());
+  exprt result;
+  domain.project_on_vars(inv, vars, result);
+  return result;
 }
 
 /*******************************************************************\
 
-Function: fixed_pointt::iteration
+Function: fixed_pointt::intervals
 
   Inputs:
 
- Outputs: 'true' if there is a change in the state predicate
+ Outputs: the invariant over the pre-state variables
 
  Purpose:
 
 \*******************************************************************/
 
-bool fixed_pointt::iteration()
+exprt fixed_pointt::intervals(
+  incremental_solvert &solver,
+  const domaint::var_specst &var_specs,
+  replace_mapt &renaming_map)
 {
-  #if 0
-  solvert solver(ns);
+  // numerical variables only
+  domaint::var_specst numerical_var_specs;
+  for(domaint::var_specst::const_iterator v=var_specs.begin();
+      v!=var_specs.end(); v++)
+  {
+    const typet &type=v->var.type();
+    if(type.id()==ID_unsignedbv || type.id()==ID_signedbv ||
+       type.id()==ID_floatbv)
+      numerical_var_specs.push_back(*v);
+  }
 
-  // Feed transition relation into solver.
-  for(constraintst::const_iterator
-      it=transition_relation.begin();
-      it!=transition_relation.end();
-      it++)
-    solver << *it;
+  if(numerical_var_specs.empty())
+    return true_exprt();
 
-  // Feed current state predicate into solver.
-  state_predicate.set_to_true(solver);
-  
-  #ifdef DEBUG
-  std::cout << "Entry state:\n";
-  output(std::cout);
-  #endif
+  tpolyhedra_domaint domain(1, renaming_map);
+  domain.add_interval_template(numerical_var_specs, ns);
+  strategy_solver_binsearcht strategy_solver(domain, solver, ns);
 
-  // solve
-  solver.dec_solve();
- 
-  #ifdef DEBUG
-  std::cout << "=======================\n";
-  solver.print_assignment(std::cout);
-  std::cout << "=======================\n";
-  #endif
+  tpolyhedra_domaint::templ_valuet inv;
+  domain.initialize(inv);
 
-  // now get new post-state
-  predicatet post_state;
-  post_state.state_vars=post_state_vars;
-  
-  post_state.get(solver);
+  bool change;
 
-  #ifdef DEBUG
-  std::cout << "Post state:\n";
-  post_state.output(std::cout);
-  #endif
-    
-  // Now 'OR' with previous state predicate.
-  // First rename post-state to pre-state.
-  post_state.rename(pre_state_vars);
-    
-  // Form disjunction of previous state predicate and the new one.
-  return state_predicate.disjunction(post_state);
-  #endif
-  
-  return false;
+  do
+  {
+    iteration_number++;
+
+    #ifdef DEBUG
+    std::cout << "\n"
+              << "******** Forward least fixed-point iteration #"
+              << iteration_number << " (intervals)\n";
+    #endif
+
+    change=strategy_solver.iterate(inv);
+  }
+  while(change);
+
+  domaint::var_sett vars(pre_state_vars.begin(), pre_state_vars.end());
+  exprt result;
+  domain.project_on_vars(inv, vars, result);
+  return result;
 }
 
 /*******************************************************************\
@@ -136,5 +230,5 @@ Function: fixed_pointt::output
 
 void fixed_pointt::output(std::ostream &out) const
 {
-  state_predicate.output(out);
+  out << from_expr(ns, "", state_predicate) << "\n";
 }
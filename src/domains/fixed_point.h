@@ -6,25 +6,45 @@ Author: Daniel Kroening, kroening@kroening.com
 
 \*******************************************************************/
 
-#ifndef DELTACHECK_FIXED_POINT_H
-#define DELTACHECK_FIXED_POINT_H
+#ifndef CPROVER_DOMAINS_FIXED_POINT_H
+#define CPROVER_DOMAINS_FIXED_POINT_H
 
-#include "predicate.h"
+#include <list>
+#include <vector>
+
+#include <util/std_expr.h>
+#include <util/decision_procedure.h>
+
+#include "incremental_solver.h"
+#include "domain.h"
 
 class fixed_pointt
 {
 public:
-  explicit fixed_pointt(const namespacet &_ns):ns(_ns)
+  explicit fixed_pointt(const namespacet &_ns):
+    use_equalities(true),
+    use_intervals(true),
+    ns(_ns)
   {
   }  
 
   typedef std::list<exprt> constraintst;
   constraintst transition_relation;
   
-  predicatet::state_var_listt pre_state_vars, post_state_vars;
+  typedef std::vector<symbol_exprt> state_var_listt;
+  state_var_listt pre_state_vars, post_state_vars;
+
+  // For each state variable: the condition under which the
+  // pre-state is reached via the back edge (loop head guard and
+  // loop select) and the condition for taking the back edge.
+  // Defaults to 'true' if not given.
+  std::vector<exprt> pre_guards, post_guards;
+
+  // the abstract domains to use
+  bool use_equalities, use_intervals;
 
   // this is over pre_state_vars  
-  predicatet state_predicate;
+  exprt state_predicate;
 
   void output(std::ostream &) const;
   
@@ -35,9 +55,16 @@ public:
 protected:
   const namespacet &ns;
 
-  // fixed-point iteration
-  void initialize();
-  bool iteration();
+  void get_var_specs(domaint::var_specst &var_specs,
+                     replace_mapt &renaming_map) const;
+
+  // fixed-point iteration in the given domain
+  exprt equalities(incremental_solvert &solver,
+                   const domaint::var_specst &var_specs,
+                   replace_mapt &renaming_map);
+  exprt intervals(incremental_solvert &solver,
+                  const domaint::var_specst &var_specs,
+                  replace_mapt &renaming_map);
 };
 
 static inline decision_proceduret & operator << (
@@ -3,6 +3,7 @@
 #include <cmath>
 
 #include <solvers/flattening/bv_pointers.h>
+#include <solvers/sat/cnf.h>
 #include <util/i2string.h>
 
 #include "incremental_solver.h"
@@ -56,6 +57,7 @@ void incremental_solvert::pop_context()
 #else
   formula.push_back(!activation_literal);
 #endif
+  dead_contexts++;
 
 #ifdef DEBUG_OUTPUT
     debug() << "pop context: " << activation_literal << eom;
@@ -76,6 +78,7 @@ void incremental_solvert::make_context_permanent()
   assert(!activation_literals.empty());
   literalt activation_literal = activation_literals.back();
   activation_literals.pop_back();
+  gc_blocked = true; //the context's constraints are not recorded
 #ifndef DEBUG_FORMULA
   solver->set_to_true(literal_exprt(activation_literal));
 #else
@@ -119,3 +122,92 @@ void incremental_solvert::debug_add_to_formula(const exprt &expr)
   }
 #endif
 }
+
+static bool contains_literal(const exprt &expr)
+{
+  if(expr.id()==ID_literal)
+    return true;
+  forall_operands(it, expr)
+    if(contains_literal(*it))
+      return true;
+  return false;
+}
+
+// remembers a constraint that is added outside of any
+// context such that it can be replayed after a rebuild;
+// constraints over literals of the current solver cannot;
+// the SSA is added again in every round, but recorded once
+void incremental_solvert::record_permanent(const exprt &expr)
+{
+  if(gc_threshold==0 || gc_blocked)
+    return;
+  if(contains_literal(expr))
+  {
+    gc_blocked = true;
+    permanent_constraints.clear();
+    recorded_constraints.clear();
+    return;
+  }
+  if(recorded_constraints.insert(expr).second)
+    permanent_constraints.push_back(expr);
+}
+
+// all constraints over the symbols of a domain are added
+// within the contexts of the strategy solver and are gone
+// once it has finished; hence, a later domain with the same
+// template can take over the symbols together with the
+// literals the solver has already cached for them
+unsigned incremental_solvert::shared_domain_number(const irept &signature)
+{
+  std::map<irept, unsigned>::const_iterator it =
+    domain_signatures.find(signature);
+  if(it!=domain_signatures.end())
+  {
+    shared_domains++;
+    return it->second;
+  }
+  unsigned number = next_domain_number();
+  domain_signatures[signature] = number;
+  return number;
+}
+
+unsigned long incremental_solvert::number_of_clauses() const
+{
+  const cnf_solvert *cnf = dynamic_cast<const cnf_solvert *>(sat_check);
+  return cnf==NULL ? 0 : cnf->no_clauses();
+}
+
+// the popped contexts leave their constraints and
+// activation literals in the solver; once there are
+// enough of them, the solver is replaced by a fresh one
+// that only contains the permanent constraints.
+// Must only be called when nobody holds on to literals
+// of the solver, and not within a context.
+bool incremental_solvert::collect_garbage()
+{
+#ifdef NON_INCREMENTAL
+  return false;
+#else
+  if(gc_threshold==0 || gc_blocked || 
+     dead_contexts<gc_threshold || !activation_literals.empty())
+    return false;
+
+  unsigned long clauses_before = number_of_clauses();
+
+  deallocate_solvers();
+  allocate_solvers(arith_refinement);
+  for(constraintst::const_iterator it = permanent_constraints.begin(); 
+      it != permanent_constraints.end(); it++)
+    *solver << *it;
+
+  unsigned long clauses_after = number_of_clauses();
+  if(clauses_before>clauses_after)
+    reclaimed_clauses += clauses_before-clauses_after;
+  dead_contexts = 0;
+  rebuilds++;
+
+  debug() << "Solver rebuilt: " << clauses_before << " -> " 
+          << clauses_after << " clauses" << eom;
+  return true;
+#endif
+}
@@ -12,12 +12,14 @@ Author: Peter Schrammel
 #include <map>
 #include <iostream>
 
+#include <util/hash_cont.h>
 #include <solvers/flattening/bv_pointers.h>
 #include <solvers/refinement/bv_refinement.h>
 #include <solvers/sat/satcheck.h>
 
 #include "domain.h"
 #include "util.h"
+#include "profiling.h"
 
 //#define DISPLAY_FORMULA
 //#define NO_ARITH_REFINEMENT
@@ -41,8 +43,15 @@ class incremental_solvert : public messaget
     ns(_ns),
     activation_literal_counter(0),
     domain_number(0),
+    shared_domains(0),
     arith_refinement(_arith_refinement),
-    solver_calls(0)
+    solver_calls(0),
+    solver_time(0),
+    gc_threshold(0),
+    gc_blocked(false),
+    dead_contexts(0),
+    rebuilds(0),
+    reclaimed_clauses(0)
   { 
     allocate_solvers(_arith_refinement);
     contexts.push_back(constraintst());
@@ -94,7 +103,10 @@ class incremental_solvert : public messaget
 #endif
 #endif
 
-    return (*solver)();    
+    double start=profilert::wall_time();
+    decision_proceduret::resultt result=(*solver)();
+    solver_time+=profilert::wall_time()-start;
+    return result;
   }
 
   exprt get(const exprt& expr) { return solver->get(expr); }
@@ -102,8 +114,23 @@ class incremental_solvert : public messaget
   literalt convert(const exprt& expr) { return solver->convert(expr); }
 
   unsigned get_number_of_solver_calls() { return solver_calls; }
+  // wall-clock seconds spent in the solver
+  double get_solver_time() { return solver_time; }
 
   unsigned next_domain_number() { return domain_number++; }
+  // domains with identical templates get the same number such that
+  //   their symbols and the literals of their rows are converted only once
+  unsigned shared_domain_number(const irept &signature);
+  unsigned get_number_of_shared_domains() const { return shared_domains; }
+
+  // garbage collection: after the given number of popped contexts,
+  //   the solver is rebuilt from the permanent constraints
+  //   at the next call of collect_garbage (0: never)
+  void set_gc_threshold(unsigned threshold) { gc_threshold=threshold; }
+  bool collect_garbage();
+  unsigned get_number_of_rebuilds() const { return rebuilds; }
+  unsigned long get_reclaimed_clauses() const { return reclaimed_clauses; }
+  void record_permanent(const exprt &expr);
 
   static incremental_solvert *allocate(const namespacet &_ns,
 				       bool arith_refinement=false) 
@@ -134,10 +161,23 @@ class incremental_solvert : public messaget
  protected:
   unsigned activation_literal_counter;
   unsigned domain_number; //ids for each domain instance to make symbols unique
+  std::map<irept, unsigned> domain_signatures;
+  unsigned shared_domains;
   bool arith_refinement;
 
   //statistics
   unsigned solver_calls;
+  double solver_time;
+
+  //garbage collection
+  unsigned gc_threshold;
+  bool gc_blocked; //constraints refer to solver literals
+  unsigned dead_contexts;
+  constraintst permanent_constraints;
+  hash_set_cont<exprt, irep_hash> recorded_constraints;
+  unsigned rebuilds;
+  unsigned long reclaimed_clauses;
+  unsigned long number_of_clauses() const;
 
   void allocate_solvers(bool arith_refinement)
   {
@@ -181,7 +221,10 @@ static inline incremental_solvert & operator << (
     *dest.solver << or_exprt(src,
 			    literal_exprt(!dest.activation_literals.back()));
   else 
+  {
+    dest.record_permanent(src);
     *dest.solver << src;
+  }
 #else
   if(!dest.activation_literals.empty())
     dest.debug_add_to_formula(
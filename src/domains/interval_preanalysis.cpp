@@ -0,0 +1,404 @@
+/*******************************************************************\
+
+Module: Interval Pre-Analysis on SSA
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#include <util/arith_tools.h>
+#include <util/std_types.h>
+
+#include "interval_preanalysis.h"
+
+/*******************************************************************\
+
+Function: interval_preanalysist::intervalt::join
+
+  Inputs:
+
+ Outputs: true if the interval has changed
+
+ Purpose:
+
+\*******************************************************************/
+
+bool interval_preanalysist::intervalt::join(const intervalt &other)
+{
+  if(other.bottom) return false;
+  if(bottom)
+  {
+    *this = other;
+    return true;
+  }
+  bool changed = false;
+  if(other.lower<lower) { lower = other.lower; changed = true; }
+  if(other.upper>upper) { upper = other.upper; changed = true; }
+  return changed;
+}
+
+/*******************************************************************\
+
+Function: interval_preanalysist::operator()
+
+  Inputs:
+
+ Outputs: false if no result has been obtained
+
+ Purpose: evaluates the SSA equations in program order;
+          the loop-back variables are updated with the values
+          at the end of the loop until stabilization,
+          with widening after widening_delay iterations
+
+\*******************************************************************/
+
+bool interval_preanalysist::operator()()
+{
+  values.clear();
+  loop_back_values.clear();
+  defined.clear();
+  unconstrained.clear();
+  iterations = 0;
+
+  if(SSA.goto_function.body.instructions.empty())
+    return false;
+
+  for(local_SSAt::nodest::const_iterator n_it = SSA.nodes.begin();
+      n_it != SSA.nodes.end(); n_it++)
+  {
+    if(n_it->marked) continue;
+    for(local_SSAt::nodet::equalitiest::const_iterator
+          e_it=n_it->equalities.begin();
+        e_it!=n_it->equalities.end();
+        e_it++)
+    {
+      if(e_it->lhs().id()!=ID_symbol) continue;
+      const irep_idt &id = to_symbol_expr(e_it->lhs()).get_identifier();
+      // equalities disabled by incremental unwinding do not constrain
+      if(n_it->enabling_expr.is_true())
+        defined.insert(id);
+      else
+        unconstrained.insert(id);
+    }
+  }
+
+  for(replace_mapt::const_iterator it = post_renaming_map.begin();
+      it != post_renaming_map.end(); it++)
+  {
+    if(it->first.id()!=ID_symbol) continue;
+    loop_back_values[to_symbol_expr(it->first).get_identifier()] =
+      intervalt();
+  }
+
+  bool change;
+  do
+  {
+    iterations++;
+    change = false;
+
+    // one pass in program order
+    for(local_SSAt::nodest::const_iterator n_it = SSA.nodes.begin();
+        n_it != SSA.nodes.end(); n_it++)
+    {
+      if(n_it->marked || !n_it->enabling_expr.is_true()) continue;
+      for(local_SSAt::nodet::equalitiest::const_iterator
+            e_it=n_it->equalities.begin();
+          e_it!=n_it->equalities.end();
+          e_it++)
+      {
+        if(e_it->lhs().id()!=ID_symbol) continue;
+        intervalt v;
+        if(!eval(e_it->rhs(), v)) continue; // type not supported
+        values[to_symbol_expr(e_it->lhs()).get_identifier()] = v;
+      }
+    }
+
+    // propagate the values at the loop ends and entries
+    //  to the loop-back variables
+    for(replace_mapt::const_iterator it = post_renaming_map.begin();
+        it != post_renaming_map.end(); it++)
+    {
+      if(it->first.id()!=ID_symbol) continue;
+      intervalt v;
+      if(!eval(it->second, v)) continue;
+      replace_mapt::const_iterator i_it = init_renaming_map.find(it->first);
+      if(i_it!=init_renaming_map.end())
+      {
+        intervalt init;
+        if(eval(i_it->second, init)) v.join(init);
+      }
+
+      intervalt &lb =
+        loop_back_values[to_symbol_expr(it->first).get_identifier()];
+      intervalt old = lb;
+      if(!lb.join(v)) continue;
+      change = true;
+
+      // widening
+      if(iterations>widening_delay && !old.bottom)
+      {
+        mp_integer lower, upper;
+        get_type_range(it->first.type(), lower, upper);
+        if(lb.lower<old.lower) lb.lower = lower;
+        if(lb.upper>old.upper) lb.upper = upper;
+      }
+    }
+  }
+  while(change);
+
+  return true;
+}
+
+/*******************************************************************\
+
+Function: interval_preanalysist::get_interval
+
+  Inputs:
+
+ Outputs: false if the type of the expression is not supported
+
+ Purpose:
+
+\*******************************************************************/
+
+bool interval_preanalysist::get_interval(
+  const exprt &expr,
+  intervalt &result) const
+{
+  return eval(expr, result);
+}
+
+/*******************************************************************\
+
+Function: interval_preanalysist::is_constant
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+bool interval_preanalysist::is_constant(const exprt &expr) const
+{
+  intervalt v;
+  return eval(expr, v) && v.is_constant();
+}
+
+/*******************************************************************\
+
+Function: interval_preanalysist::eval_symbol
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+bool interval_preanalysist::eval_symbol(
+  const exprt &expr,
+  intervalt &result) const
+{
+  if(expr.id()==ID_symbol)
+  {
+    const irep_idt &id = to_symbol_expr(expr).get_identifier();
+
+    valuest::const_iterator l_it = loop_back_values.find(id);
+    if(l_it!=loop_back_values.end())
+    {
+      result = l_it->second;
+      return true;
+    }
+
+    if(unconstrained.find(id)==unconstrained.end())
+    {
+      valuest::const_iterator v_it = values.find(id);
+      if(v_it!=values.end())
+      {
+        result = v_it->second;
+        return true;
+      }
+      if(defined.find(id)!=defined.end())
+      {
+        result = intervalt(); // not evaluated yet
+        return true;
+      }
+    }
+  }
+
+  // inputs, nondeterministic values, return values of calls
+  return get_type_range(expr.type(), result);
+}
+
+/*******************************************************************\
+
+Function: interval_preanalysist::eval
+
+  Inputs:
+
+ Outputs: false if the type of the expression is not supported
+
+ Purpose:
+
+\*******************************************************************/
+
+bool interval_preanalysist::eval(const exprt &expr, intervalt &result) const
+{
+  const typet &type = expr.type();
+  mp_integer type_lower, type_upper;
+  if(!get_type_range(type, type_lower, type_upper))
+    return false;
+
+  if(expr.id()==ID_constant)
+  {
+    mp_integer v;
+    if(to_integer(expr, v))
+      return get_type_range(type, result);
+    result = intervalt(v, v);
+    return true;
+  }
+  else if(expr.id()==ID_symbol || expr.id()==ID_nondet_symbol)
+  {
+    return eval_symbol(expr, result);
+  }
+  else if(expr.id()==ID_typecast)
+  {
+    const exprt &op = to_typecast_expr(expr).op();
+    if(op.type().id()==ID_bool)
+      result = intervalt(0, 1);
+    else if(!eval(op, result))
+      return get_type_range(type, result);
+  }
+  else if(expr.id()==ID_if)
+  {
+    const if_exprt &if_expr = to_if_expr(expr);
+    intervalt false_value;
+    if(!eval(if_expr.true_case(), result))
+      get_type_range(type, result);
+    if(!eval(if_expr.false_case(), false_value))
+      get_type_range(type, false_value);
+    result.join(false_value);
+  }
+  else if(expr.id()==ID_unary_minus)
+  {
+    if(!eval(expr.op0(), result))
+      return get_type_range(type, result);
+    if(!result.bottom)
+    {
+      mp_integer lower = -result.upper;
+      result.upper = -result.lower;
+      result.lower = lower;
+    }
+  }
+  else if((expr.id()==ID_plus || expr.id()==ID_minus ||
+           expr.id()==ID_mult) && expr.operands().size()>=2)
+  {
+    if(!eval(expr.op0(), result))
+      return get_type_range(type, result);
+    for(unsigned i=1; i<expr.operands().size(); i++)
+    {
+      intervalt v;
+      if(!eval(expr.operands()[i], v))
+        return get_type_range(type, result);
+      if(result.bottom || v.bottom)
+      {
+        result = intervalt();
+        return true;
+      }
+
+      if(expr.id()==ID_plus)
+      {
+        result.lower += v.lower;
+        result.upper += v.upper;
+      }
+      else if(expr.id()==ID_minus)
+      {
+        mp_integer lower = result.lower - v.upper;
+        result.upper = result.upper - v.lower;
+        result.lower = lower;
+      }
+      else // ID_mult
+      {
+        mp_integer p[4];
+        p[0] = result.lower * v.lower;
+        p[1] = result.lower * v.upper;
+        p[2] = result.upper * v.lower;
+        p[3] = result.upper * v.upper;
+        result.lower = p[0];
+        result.upper = p[0];
+        for(unsigned j=1; j<4; j++)
+        {
+          if(p[j]<result.lower) result.lower = p[j];
+          if(p[j]>result.upper) result.upper = p[j];
+        }
+      }
+    }
+  }
+  else
+    return get_type_range(type, result);
+
+  // bit-vector arithmetic wraps around
+  clamp_to_type(type, result);
+  return true;
+}
+
+/*******************************************************************\
+
+Function: interval_preanalysist::get_type_range
+
+  Inputs:
+
+ Outputs: false if the type is not supported
+
+ Purpose:
+
+\*******************************************************************/
+
+bool interval_preanalysist::get_type_range(
+  const typet &type,
+  mp_integer &lower,
+  mp_integer &upper)
+{
+  if(type.id()==ID_signedbv)
+  {
+    lower = to_signedbv_type(type).smallest();
+    upper = to_signedbv_type(type).largest();
+    return true;
+  }
+  if(type.id()==ID_unsignedbv)
+  {
+    lower = to_unsignedbv_type(type).smallest();
+    upper = to_unsignedbv_type(type).largest();
+    return true;
+  }
+  return false;
+}
+
+/*******************************************************************\
+
+Function: interval_preanalysist::clamp_to_type
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: go to the full type range if the value may overflow
+
+\*******************************************************************/
+
+void interval_preanalysist::clamp_to_type(
+  const typet &type,
+  intervalt &result)
+{
+  if(result.bottom) return;
+  mp_integer lower, upper;
+  if(!get_type_range(type, lower, upper)) return;
+  if(result.lower<lower || result.upper>upper)
+  {
+    result.lower = lower;
+    result.upper = upper;
+  }
+}
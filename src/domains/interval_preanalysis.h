@@ -0,0 +1,97 @@
+/*******************************************************************\
+
+Module: Interval Pre-Analysis on SSA
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#ifndef CPROVER_INTERVAL_PREANALYSIS_H
+#define CPROVER_INTERVAL_PREANALYSIS_H
+
+#include <map>
+#include <set>
+
+#include <util/mp_arith.h>
+#include <util/replace_expr.h>
+
+#include "../ssa/local_ssa.h"
+
+/* A cheap, path-insensitive interval analysis over the SSA equations
+   that does not call any solver. Guards are ignored and loops are
+   widened to the type bounds after a few iterations.
+   Its results are used to prune and bound the template rows
+   before the SAT-based optimization. */
+
+class interval_preanalysist
+{
+public:
+  class intervalt
+  {
+  public:
+    intervalt() : bottom(true) {}
+    intervalt(const mp_integer &_lower, const mp_integer &_upper) :
+      bottom(false), lower(_lower), upper(_upper) {}
+
+    bool bottom;
+    mp_integer lower, upper;
+
+    bool is_constant() const { return !bottom && lower==upper; }
+    bool join(const intervalt &other); // returns true if changed
+  };
+
+  // post_renaming_map: loop-back variables -> value at loop end
+  // init_renaming_map: loop-back variables -> value at loop entry
+  explicit interval_preanalysist(
+    const local_SSAt &_SSA,
+    const replace_mapt &_post_renaming_map,
+    const replace_mapt &_init_renaming_map,
+    unsigned _widening_delay=3) :
+    SSA(_SSA),
+    post_renaming_map(_post_renaming_map),
+    init_renaming_map(_init_renaming_map),
+    widening_delay(_widening_delay),
+    iterations(0)
+  {}
+
+  // returns false if no result has been obtained
+  bool operator()();
+
+  // interval of the given expression over the values
+  // at the end of the loops (loop-back variables) and
+  // the values of all other SSA variables
+  // returns false if the type of the expression is not supported
+  bool get_interval(const exprt &expr, intervalt &result) const;
+
+  bool is_constant(const exprt &expr) const;
+
+  unsigned get_number_of_iterations() { return iterations; }
+
+protected:
+  const local_SSAt &SSA;
+  const replace_mapt &post_renaming_map;
+  const replace_mapt &init_renaming_map;
+  unsigned widening_delay;
+  unsigned iterations;
+
+  typedef std::map<irep_idt, intervalt> valuest;
+  valuest values; // SSA variables defined by equalities
+  valuest loop_back_values; // loop-back variables
+
+  std::set<irep_idt> defined; // to be evaluated
+  std::set<irep_idt> unconstrained; // only conditionally defined
+
+  bool eval(const exprt &expr, intervalt &result) const;
+  bool eval_symbol(const exprt &expr, intervalt &result) const;
+
+  static bool get_type_range(const typet &type,
+			     mp_integer &lower, mp_integer &upper);
+  static bool get_type_range(const typet &type, intervalt &result)
+  {
+    result.bottom = false;
+    return get_type_range(type, result.lower, result.upper);
+  }
+  static void clamp_to_type(const typet &type, intervalt &result);
+};
+
+#endif
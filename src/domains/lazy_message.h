@@ -0,0 +1,100 @@
+/*******************************************************************\
+
+Module: Verbosity-gated Message Formatting
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#ifndef CPROVER_LAZY_MESSAGE_H
+#define CPROVER_LAZY_MESSAGE_H
+
+#include <ostream>
+
+#include <util/message.h>
+#include <util/namespace.h>
+#include <langapi/language_util.h>
+
+/* Pretty-printing expressions, SSA and summaries is expensive
+   and most of it goes to debug() or status(), which are discarded
+   at the default verbosity. 
+
+   message_enabled() tells whether a message level is output at all,
+   so that whole blocks that prepare messages can be skipped;
+   without a message handler nothing is output.
+   Formatters are closures that are output to a stream: 
+   on a message stream they are only evaluated if the level 
+   of the stream is enabled. */
+
+inline bool message_enabled(messaget &message, unsigned level)
+{
+  message_handlert *handler=&message.get_message_handler();
+  return handler!=NULL && level<=handler->get_verbosity();
+}
+
+class message_formattert
+{
+public:
+  virtual ~message_formattert() { }
+  virtual void operator()(std::ostream &out) const=0;
+};
+
+inline std::ostream &operator<<(
+  std::ostream &out,
+  const message_formattert &formatter)
+{
+  messaget::mstreamt *m=dynamic_cast<messaget::mstreamt *>(&out);
+  if(m==NULL || message_enabled(m->message, m->message_level))
+    formatter(out);
+  return out;
+}
+
+// pretty-prints an expression
+class expr_formattert:public message_formattert
+{
+public:
+  expr_formattert(const namespacet &_ns, const exprt &_expr):
+    ns(_ns), expr(_expr) { }
+
+  virtual void operator()(std::ostream &out) const
+  {
+    out << from_expr(ns, "", expr);
+  }
+
+protected:
+  const namespacet &ns;
+  const exprt &expr;
+};
+
+inline expr_formattert lazy_expr(const namespacet &ns, const exprt &expr)
+{
+  return expr_formattert(ns, expr);
+}
+
+// calls the output method of an object (SSA, summary, domain, ...)
+template<class T>
+class output_formattert:public message_formattert
+{
+public:
+  output_formattert(const T &_object, const namespacet &_ns):
+    object(_object), ns(_ns) { }
+
+  virtual void operator()(std::ostream &out) const
+  {
+    object.output(out, ns);
+  }
+
+protected:
+  const T &object;
+  const namespacet &ns;
+};
+
+template<class T>
+inline output_formattert<T> lazy_output(
+  const T &object, 
+  const namespacet &ns)
+{
+  return output_formattert<T>(object, ns);
+}
+
+#endif
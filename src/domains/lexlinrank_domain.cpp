@@ -28,18 +28,13 @@ void lexlinrank_domaint::initialize(valuet &value)
   }
 }
 
-bool lexlinrank_domaint::refine()
+bool lexlinrank_domaint::refine_row(unsigned &refinement_level) const
 {
   if(refinement_level>=MAX_REFINEMENT) return false;
   refinement_level++;
   return true;
 }
 
-void lexlinrank_domaint::reset_refinements()
-{
-  refinement_level = 0;
-}
-
 exprt lexlinrank_domaint::get_not_constraints(const lexlinrank_domaint::templ_valuet &value,
 			    exprt::operandst &cond_exprs,
 			    std::vector<pre_post_valuest> &value_exprs)
@@ -172,6 +167,7 @@ exprt lexlinrank_domaint::get_not_constraints(const lexlinrank_domaint::templ_va
 exprt lexlinrank_domaint::get_row_symb_constraint(row_valuet &symb_values, // contains vars c and d
 						  const rowt &row,
 						  const pre_post_valuest &values,
+						  unsigned refinement_level,
 						  exprt &refinement_constraint)
 {
   // NOTE: I assume symb_values.size was set to the number of
@@ -40,15 +40,14 @@ public:
 
 
   lexlinrank_domaint(unsigned _domain_number, replace_mapt &_renaming_map) :
-    domaint(_domain_number,_renaming_map),
-    refinement_level(0)
+    domaint(_domain_number,_renaming_map)
   {}
 
   // initialize value
   virtual void initialize(valuet &value);
 
-  virtual bool refine();
-  virtual void reset_refinements();
+  // the refinement level is kept per row by the caller
+  bool refine_row(unsigned &refinement_level) const;
 
   // value -> constraints
   exprt get_not_constraints(const templ_valuet &value,
@@ -57,6 +56,7 @@ public:
   exprt get_row_symb_constraint(row_valuet &symb_values, // contains vars c and d
 			       const rowt &row,
 			       const pre_post_valuest &values,
+			       unsigned refinement_level,
 			       exprt &refinement_constraint
 			       );
 
@@ -82,7 +82,6 @@ public:
 
 protected:
   templatet templ;
-  unsigned refinement_level;
 
   bool is_row_value_false(const row_valuet & row_value) const;
   bool is_row_value_true(const row_valuet & row_value) const;
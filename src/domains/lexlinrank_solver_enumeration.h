@@ -21,24 +21,27 @@ class lexlinrank_solver_enumerationt : public strategy_solver_baset
   strategy_solver_baset(_solver, _ns),
     lexlinrank_domain(_lexlinrank_domain), 
     max_elements(_max_elements),
-    max_inner_iterations(_max_inner_iterations),
-    number_inner_iterations(0)
+    max_inner_iterations(_max_inner_iterations)
   {
-    inner_solver = incremental_solvert::allocate(_ns);
-    solver_instances++;
   }
 
+  virtual ~lexlinrank_solver_enumerationt();
+
   virtual bool iterate(invariantt &inv);
 
  protected:
   lexlinrank_domaint &lexlinrank_domain;
   const unsigned max_elements; // lexicographic components
 
-  // the "inner" solver
+  // the "inner" solvers, one per row
   const unsigned max_inner_iterations;
-  incremental_solvert *inner_solver;
-  unsigned number_inner_iterations; 
+  std::vector<incremental_solvert *> inner_solvers;
+  std::vector<unsigned> number_inner_iterations;
+  std::vector<unsigned> number_elements_per_row;
+  std::vector<unsigned> refinement_levels;
 
+  void resize(unsigned rows);
+  void reset_inner_solver(unsigned row);
 };
 
 #endif
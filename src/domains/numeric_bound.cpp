@@ -0,0 +1,180 @@
+/*******************************************************************\
+
+Module: Numeric Representation of Template Row Bounds
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#include <cassert>
+
+#include <util/arith_tools.h>
+#include <util/std_types.h>
+
+#include "numeric_bound.h"
+
+#define SMALL_WIDTH 62
+
+/*******************************************************************\
+
+Function: numeric_boundt::is_supported
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+bool numeric_boundt::is_supported(const typet &type)
+{
+  return type.id()==ID_signedbv || type.id()==ID_unsignedbv ||
+    type.id()==ID_floatbv;
+}
+
+/*******************************************************************\
+
+Function: numeric_boundt::numeric_boundt
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: reads the bit-string of small integers directly
+
+\*******************************************************************/
+
+numeric_boundt::numeric_boundt(const constant_exprt &expr):
+  type(expr.type()), small(0)
+{
+  if(type.id()==ID_floatbv)
+  {
+    kind=FLOAT;
+    floating=ieee_floatt(expr);
+    return;
+  }
+
+  assert(type.id()==ID_signedbv || type.id()==ID_unsignedbv);
+  const std::string &value=id2string(expr.get_value());
+  std::size_t width=to_bitvector_type(type).get_width();
+
+  if(width>SMALL_WIDTH || value.size()!=width)
+  {
+    kind=BIG;
+    bool error=to_integer(expr, big);
+    assert(!error);
+    return;
+  }
+
+  kind=SMALL;
+  unsigned long long u=0;
+  for(std::size_t i=0; i<width; i++)
+    u=(u<<1) | (value[i]=='1' ? 1 : 0);
+  if(type.id()==ID_signedbv && width>0 && value[0]=='1')
+    small=(long long)u-(1LL<<width); // two's complement
+  else
+    small=(long long)u;
+}
+
+/*******************************************************************\
+
+Function: numeric_boundt::to_expr
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+constant_exprt numeric_boundt::to_expr() const
+{
+  if(kind==FLOAT)
+    return floating.to_expr();
+  if(kind==BIG)
+    return to_constant_expr(from_integer(big, type));
+
+  std::size_t width=to_bitvector_type(type).get_width();
+  unsigned long long u=(unsigned long long)small;
+  std::string value(width, '0');
+  for(std::size_t i=0; i<width; i++)
+    if((u>>i) & 1) value[width-1-i]='1';
+
+  constant_exprt result(type);
+  result.set_value(value);
+  return result;
+}
+
+/*******************************************************************\
+
+Function: numeric_boundt::operator<
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+bool numeric_boundt::operator<(const numeric_boundt &other) const
+{
+  if(kind==SMALL && other.kind==SMALL)
+    return small<other.small;
+  if(kind==FLOAT && other.kind==FLOAT)
+    return floating<other.floating;
+  assert(kind!=FLOAT && other.kind!=FLOAT); //types do not match
+  return get_integer()<other.get_integer();
+}
+
+/*******************************************************************\
+
+Function: numeric_boundt::between
+
+  Inputs: lower<=upper of the same type
+
+ Outputs: (lower+upper)/2 rounded towards zero, 
+          lower if upper is its successor
+
+ Purpose: floats: "median" float number by the mean of
+          their integer representations
+
+\*******************************************************************/
+
+numeric_boundt numeric_boundt::between(
+  const numeric_boundt &lower,
+  const numeric_boundt &upper)
+{
+  assert(lower.kind==upper.kind);
+  numeric_boundt result(lower.type, lower.kind);
+
+  if(lower.kind==SMALL)
+  {
+    assert(upper.small>=lower.small);
+    if(lower.small+1==upper.small)
+      return lower; //floor
+    result.small=(upper.small+lower.small)/2;
+  }
+  else if(lower.kind==BIG)
+  {
+    assert(upper.big>=lower.big);
+    if(lower.big+1==upper.big)
+      return lower; //floor
+    result.big=(upper.big+lower.big)/2;
+  }
+  else if(lower.floating.get_sign()==upper.floating.get_sign())
+  {
+    mp_integer plower=lower.floating.pack();
+    mp_integer pupper=upper.floating.pack();
+    result.floating=ieee_floatt(to_floatbv_type(lower.type));
+    result.floating.unpack((plower+pupper)/2);
+  }
+  else
+  {
+    result.floating=ieee_floatt(to_floatbv_type(lower.type));
+    result.floating.make_zero();
+  }
+  return result;
+}
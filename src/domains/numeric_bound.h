@@ -0,0 +1,58 @@
+/*******************************************************************\
+
+Module: Numeric Representation of Template Row Bounds
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#ifndef CPROVER_NUMERIC_BOUND_H
+#define CPROVER_NUMERIC_BOUND_H
+
+#include <util/std_expr.h>
+#include <util/mp_arith.h>
+#include <util/ieee_float.h>
+
+/* A bound of a template row as a number rather than a
+   bit-string constant. Integers of up to 62 bits are kept
+   in a machine word such that sums of two bounds cannot
+   overflow; wider integers fall back to big integers.
+   The binary search works on these and converts to an
+   expression only when emitting a constraint. */
+
+class numeric_boundt
+{
+public:
+  // placeholder to be assigned, e.g., in containers
+  numeric_boundt():kind(SMALL), small(0) {}
+  explicit numeric_boundt(const constant_exprt &expr);
+
+  constant_exprt to_expr() const;
+
+  bool operator<(const numeric_boundt &other) const;
+
+  // the "middle" between lower and upper as used by the binary search
+  static numeric_boundt between(
+    const numeric_boundt &lower,
+    const numeric_boundt &upper);
+
+  static bool is_supported(const typet &type);
+
+protected:
+  typedef enum { SMALL, BIG, FLOAT } kindt;
+  kindt kind;
+  typet type;
+  long long small;
+  mp_integer big;
+  ieee_floatt floating;
+
+  numeric_boundt(const typet &_type, kindt _kind):
+    kind(_kind), type(_type), small(0) {}
+
+  mp_integer get_integer() const 
+  { 
+    return kind==SMALL ? mp_integer(small) : big; 
+  }
+};
+
+#endif
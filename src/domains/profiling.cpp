@@ -0,0 +1,267 @@
+/*******************************************************************\
+
+Module: Profiling of the Analysis Phases
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#include <ctime>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#include <util/json.h>
+
+#include "profiling.h"
+
+profilert profiler;
+
+/*******************************************************************\
+
+Function: profilert::wall_time
+
+  Inputs:
+
+ Outputs: seconds since the epoch
+
+ Purpose:
+
+\*******************************************************************/
+
+double profilert::wall_time()
+{
+#ifdef _WIN32
+  return (double)std::time(NULL);
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec+tv.tv_usec/1e6;
+#endif
+}
+
+/*******************************************************************\
+
+Function: profilert::cpu_time
+
+  Inputs:
+
+ Outputs: CPU seconds used by this process
+
+ Purpose:
+
+\*******************************************************************/
+
+double profilert::cpu_time()
+{
+  return (double)std::clock()/CLOCKS_PER_SEC;
+}
+
+/*******************************************************************\
+
+Function: profilert::peak_memory
+
+  Inputs:
+
+ Outputs: peak resident set size in kB, 0 if unknown
+
+ Purpose:
+
+\*******************************************************************/
+
+long profilert::peak_memory()
+{
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage)!=0)
+    return 0;
+#ifdef __APPLE__
+  return usage.ru_maxrss/1024; // bytes on OS X
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+/*******************************************************************\
+
+Function: profilert::start
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: phases may be nested and re-entered (recursion)
+
+\*******************************************************************/
+
+void profilert::start(const std::string &phase)
+{
+  if(!enabled) return;
+
+  open_phaset open;
+  open.wall=wall_time();
+  open.cpu=cpu_time();
+  open_phases[phase].push_back(open);
+}
+
+/*******************************************************************\
+
+Function: profilert::stop
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void profilert::stop(const std::string &phase)
+{
+  if(!enabled) return;
+
+  open_phasest::iterator o_it=open_phases.find(phase);
+  if(o_it==open_phases.end() || o_it->second.empty())
+    return; // started before profiling was enabled
+
+  open_phaset open=o_it->second.back();
+  o_it->second.pop_back();
+
+  double wall=wall_time()-open.wall;
+  double cpu=cpu_time()-open.cpu;
+
+  phase_statst &stats=phases[phase];
+  stats.count++;
+  // a recursive phase is only accounted for at the outermost level
+  if(o_it->second.empty())
+  {
+    stats.wall+=wall;
+    stats.cpu+=cpu;
+  }
+  if(events.empty() || open.wall<origin)
+    origin=open.wall;
+  eventt event;
+  event.name=phase;
+  event.begin=open.wall;
+  event.duration=wall;
+  events.push_back(event);
+}
+
+/*******************************************************************\
+
+Function: json_number
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+static jsont json_number(double value)
+{
+  std::ostringstream out;
+  out << value;
+  return jsont::json_number(out.str());
+}
+
+static jsont json_number(long long value)
+{
+  std::ostringstream out;
+  out << value;
+  return jsont::json_number(out.str());
+}
+
+/*******************************************************************\
+
+Function: profilert::output_json
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void profilert::output_json(std::ostream &out) const
+{
+  jsont json=jsont::json_object();
+
+  jsont &j_phases=json["phases"];
+  j_phases=jsont::json_object();
+  for(phasest::const_iterator it=phases.begin();
+      it!=phases.end(); it++)
+  {
+    jsont &j_phase=j_phases[it->first];
+    j_phase=jsont::json_object();
+    j_phase["wall"]=json_number(it->second.wall);
+    j_phase["cpu"]=json_number(it->second.cpu);
+    j_phase["count"]=json_number((long long)it->second.count);
+  }
+
+  // kB, for the whole process
+  json["peak-memory"]=json_number((long long)peak_memory());
+
+  jsont &j_counters=json["counters"];
+  j_counters=jsont::json_object();
+  for(std::map<std::string, unsigned long>::const_iterator
+        it=counters.begin(); it!=counters.end(); it++)
+    j_counters[it->first]=json_number((long long)it->second);
+
+  jsont &j_functions=json["functions"];
+  j_functions=jsont::json_object();
+  for(function_statst::const_iterator it=function_stats.begin();
+      it!=function_stats.end(); it++)
+  {
+    jsont &j_function=j_functions[it->first];
+    j_function=jsont::json_object();
+    for(std::map<std::string, double>::const_iterator
+          s_it=it->second.begin(); s_it!=it->second.end(); s_it++)
+      j_function[s_it->first]=json_number(s_it->second);
+  }
+
+  out << json << "\n";
+}
+
+/*******************************************************************\
+
+Function: profilert::output_chrome_trace
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: trace event format as read by chrome://tracing,
+          timestamps in microseconds
+
+\*******************************************************************/
+
+void profilert::output_chrome_trace(std::ostream &out) const
+{
+  jsont json=jsont::json_object();
+
+  jsont &j_events=json["traceEvents"];
+  j_events=jsont::json_array();
+  for(std::vector<eventt>::const_iterator it=events.begin();
+      it!=events.end(); it++)
+  {
+    jsont j_event=jsont::json_object();
+    j_event["name"]=jsont::json_string(it->name);
+    j_event["ph"]=jsont::json_string("X");
+    j_event["ts"]=json_number((long long)((it->begin-origin)*1e6));
+    j_event["dur"]=json_number((long long)(it->duration*1e6));
+    j_event["pid"]=json_number(1LL);
+    j_event["tid"]=json_number(1LL);
+    j_events.array.push_back(j_event);
+  }
+
+  out << json << "\n";
+}
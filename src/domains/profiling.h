@@ -0,0 +1,120 @@
+/*******************************************************************\
+
+Module: Profiling of the Analysis Phases
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#ifndef CPROVER_PROFILING_H
+#define CPROVER_PROFILING_H
+
+#include <map>
+#include <vector>
+#include <string>
+#include <iostream>
+
+#include <util/irep.h>
+
+/* Collects wall time and CPU time per phase, counters
+   (e.g. strategy iterations) and statistics per function.
+   The peak memory is a high-water mark of the whole process
+   and is only reported once. Disabled by default; the
+   profiling scopes then cost a single test.
+   Not thread-safe: only to be used from the main thread. */
+
+class profilert
+{
+public:
+  profilert():enabled(false), origin(0) {}
+
+  bool enabled;
+
+  void start(const std::string &phase);
+  void stop(const std::string &phase);
+
+  void add_count(const std::string &counter, unsigned long n=1)
+  {
+    if(enabled) counters[counter]+=n;
+  }
+
+  void set_function_stat(const std::string &function,
+                         const std::string &stat, double value)
+  {
+    if(enabled) function_stats[function][stat]=value;
+  }
+
+  void output_json(std::ostream &out) const;
+  void output_chrome_trace(std::ostream &out) const;
+
+  // seconds since the epoch
+  static double wall_time();
+
+protected:
+  struct phase_statst
+  {
+    phase_statst():wall(0), cpu(0), count(0) {}
+    double wall, cpu; // seconds
+    unsigned long count;
+  };
+  typedef std::map<std::string, phase_statst> phasest;
+  phasest phases;
+
+  struct eventt
+  {
+    std::string name;
+    double begin, duration; // seconds
+  };
+  std::vector<eventt> events;
+  double origin; // begin of the earliest event
+
+  // start times of the phases not yet stopped
+  struct open_phaset
+  {
+    double wall, cpu;
+  };
+  typedef std::map<std::string, std::vector<open_phaset> > open_phasest;
+  open_phasest open_phases;
+
+  std::map<std::string, unsigned long> counters;
+
+  typedef std::map<std::string, std::map<std::string, double> >
+    function_statst;
+  function_statst function_stats;
+
+  static double cpu_time();
+  static long peak_memory();
+};
+
+extern profilert profiler;
+
+// profiles the enclosing scope as the given phase;
+// the detail, e.g. a function name, is appended to the phase name
+class profile_scopet
+{
+public:
+  explicit profile_scopet(const char *_phase,
+                          const irep_idt &_detail=irep_idt()):
+    phase(_phase), detail(_detail), enabled(profiler.enabled)
+  {
+    if(enabled) profiler.start(name());
+  }
+
+  ~profile_scopet()
+  {
+    if(enabled) profiler.stop(name());
+  }
+
+protected:
+  const char *phase;
+  const irep_idt detail;
+  bool enabled;
+
+  std::string name() const
+  {
+    return detail==irep_idt() ?
+      std::string(phase) : std::string(phase)+":"+id2string(detail);
+  }
+};
+
+#endif
@@ -2,6 +2,7 @@
 #include <util/simplify_expr.h>
 #include "ranking_solver_enumeration.h"
 #include "util.h"
+#include "lazy_message.h"
 #include <solvers/smt2/smt2_dec.h>
 
 bool ranking_solver_enumerationt::iterate(invariantt &_rank)
@@ -49,13 +50,13 @@ bool ranking_solver_enumerationt::iterate(invariantt &_rank)
 	  // model for x_i
 	 exprt value = solver.solver->get(it->first);
 	  debug() << "(RANK) Row " << row << " Value for " 
-		  << from_expr(ns,"",it->first) 
-		  << ": " << from_expr(ns,"",value) << eom;
+		  << lazy_expr(ns,it->first) 
+		  << ": " << lazy_expr(ns,value) << eom;
 	  // model for x'_i
 	  exprt post_value = solver.solver->get(it->second);
 	  debug() << "(RANK) Row " << row << " Value for " 
-		  << from_expr(ns,"",it->second) 
-		  << ": " << from_expr(ns,"",post_value) << eom;
+		  << lazy_expr(ns,it->second) 
+		  << ": " << lazy_expr(ns,post_value) << eom;
 	  // record all the values
 	  values.push_back(std::make_pair(value, post_value));
 	}
@@ -70,7 +71,7 @@ bool ranking_solver_enumerationt::iterate(invariantt &_rank)
 					    values,refinement_constraint);
 	simplify_expr(constraint, ns);
 	debug() << "Inner Solver: " << row << " constraint " 
-		    << from_expr(ns,"", constraint) << eom;
+		    << lazy_expr(ns,constraint) << eom;
 
 	inner_solver << constraint;
 
@@ -101,8 +102,8 @@ bool ranking_solver_enumerationt::iterate(invariantt &_rank)
 	    exprt v = inner_solver.solver->get(*it);
 	    new_row_values.c.push_back(v);
 	    debug() << "Inner Solver: " << row << " c value for " 
-		    << from_expr(ns,"", *it) << ": " 
-		    << from_expr(ns,"", v)  << eom;
+		    << lazy_expr(ns,*it) << ": " 
+		    << lazy_expr(ns,v)  << eom;
 	  }
 
 	  // update the current template
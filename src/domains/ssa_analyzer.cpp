@@ -25,6 +25,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include "template_generator_ranking.h"
 #include "strategy_solver_predabs.h"
 #include "ssa_analyzer.h"
+#include "profiling.h"
 
 
 #include <solvers/sat/satcheck.h>
@@ -63,6 +64,8 @@ void ssa_analyzert::operator()(incremental_solvert &solver,
   if(SSA.goto_function.body.instructions.empty())
     return;
 
+  profile_scopet profile_scope("fixed point");
+
   solver << SSA;
   SSA.mark_nodes();
 
@@ -159,6 +162,8 @@ void ssa_analyzert::operator()(incremental_solvert &solver,
   }
   while(change);
 
+  profiler.add_count("strategy iterations", iteration_number);
+
   #ifdef DEBUG
   std::cout << "Fixed-point after " << iteration_number
             << " iteration(s)\n";
@@ -170,6 +175,7 @@ void ssa_analyzert::operator()(incremental_solvert &solver,
   //statistics
   solver_instances += strategy_solver->get_number_of_solver_instances();
   solver_calls += strategy_solver->get_number_of_solver_calls();
+  iterations += iteration_number;
   solver_instances += strategy_solver->get_number_of_solver_instances();
 
   delete strategy_solver;
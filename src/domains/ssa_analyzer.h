@@ -25,7 +25,8 @@ public:
     : 
     result(NULL),
     solver_instances(0),
-    solver_calls(0)
+    solver_calls(0),
+    iterations(0)
     {
     }  
 
@@ -40,9 +41,12 @@ public:
                   template_generator_baset &template_generator);
 
   void get_result(exprt &result, const domaint::var_sett &vars);
+  // NULL if nothing has been analyzed
+  const domaint::valuet *get_value() const { return result; }
 
   unsigned get_number_of_solver_instances() { return solver_instances; }
   unsigned get_number_of_solver_calls() { return solver_calls; }
+  unsigned get_number_of_iterations() { return iterations; }
 
 protected:
   domaint *domain; //template generator is responsable for the domain object
@@ -51,6 +55,7 @@ protected:
   //statistics
   unsigned solver_instances;
   unsigned solver_calls;
+  unsigned iterations;
 };
 
 
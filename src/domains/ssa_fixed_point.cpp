@@ -40,6 +40,13 @@ void ssa_fixed_point(local_SSAt &SSA)
   {
     if(i_it->is_backwards_goto())
     {
+      // the back edge is taken from i_it to the loop head
+      exprt pre_guard=
+        and_exprt(SSA.guard_symbol(i_it->get_target()),
+                  SSA.name(SSA.guard_symbol(), local_SSAt::LOOP_SELECT, i_it));
+      exprt post_guard=
+        and_exprt(SSA.guard_symbol(i_it), SSA.cond_symbol(i_it));
+
       // Record the objects modified by the loop to get
       // 'primed' (post-state) and 'unprimed' (pre-state) variables.
       for(local_SSAt::objectst::const_iterator
@@ -52,6 +59,8 @@ void ssa_fixed_point(local_SSAt &SSA)
       
         fixed_point.pre_state_vars.push_back(in);
         fixed_point.post_state_vars.push_back(out);
+        fixed_point.pre_guards.push_back(pre_guard);
+        fixed_point.post_guards.push_back(post_guard);
       }
 
       {
@@ -61,6 +70,8 @@ void ssa_fixed_point(local_SSAt &SSA)
         
         fixed_point.pre_state_vars.push_back(in);
         fixed_point.post_state_vars.push_back(out);
+        fixed_point.pre_guards.push_back(pre_guard);
+        fixed_point.post_guards.push_back(post_guard);
       }
     }
   }
@@ -75,5 +86,5 @@ void ssa_fixed_point(local_SSAt &SSA)
   // We simply use the last CFG node. It would be prettier to put
   // these close to the loops.
   assert(SSA.nodes.begin()!=SSA.nodes.end());
-  fixed_point.state_predicate.get_constraints(SSA.nodes.back().constraints);
+  SSA.nodes.back().constraints.push_back(fixed_point.state_predicate);
 }
@@ -2,6 +2,7 @@
 
 #include "strategy_solver_binsearch.h"
 #include "util.h"
+#include "lazy_message.h"
 
 bool strategy_solver_binsearcht::iterate(invariantt &_inv)
 {
@@ -91,11 +92,27 @@ bool strategy_solver_binsearcht::iterate(invariantt &_inv)
     std::set<tpolyhedra_domaint::rowt> improve_rows;
     improve_rows.insert(row);
 
+    // the pre-analysis or the previous unwinding 
+    //   may have given us a tighter bound than the maximum
     tpolyhedra_domaint::row_valuet upper = 
-      tpolyhedra_domain.get_max_row_value(row);
+      tpolyhedra_domain.get_row_upper_bound(row);
     tpolyhedra_domaint::row_valuet lower = 
       simplify_const(solver.get(strategy_value_exprs[row]));
 
+    // the pre-analysis bound need not hold in this calling context,
+    //   the one carried over from the previous unwinding is a hint
+    if(tpolyhedra_domain.less_than(upper,lower))
+      upper = tpolyhedra_domain.get_max_row_value(row);
+
+    // already tight (or bound not reached yet): no search needed
+    if(!tpolyhedra_domain.less_than(lower,upper))
+    {
+      debug() << "update value: " << lazy_expr(ns,lower) << eom;
+      solver.pop_context();  //improvement check
+      tpolyhedra_domain.set_row_value(row,lower,inv);
+      return true;
+    }
+
     solver.pop_context();  //improvement check
     
     solver.new_context(); //symbolic value system
@@ -115,11 +132,16 @@ bool strategy_solver_binsearcht::iterate(invariantt &_inv)
     debug() << "post-inv: " << from_expr(ns,"",post_inv_expr) << eom;
 #endif
 
-    while(tpolyhedra_domain.less_than(lower,upper))   
+    // the search is done on numbers, constants are only built
+    //   for the constraints
+    numeric_boundt upper_bound(upper);
+    numeric_boundt lower_bound(lower);
+    while(lower_bound<upper_bound)   
     {
-      tpolyhedra_domaint::row_valuet middle = 
-	      tpolyhedra_domain.between(lower,upper);
-      if(!tpolyhedra_domain.less_than(lower,middle)) middle = upper;
+      numeric_boundt middle_bound = 
+	      tpolyhedra_domain.between(lower_bound,upper_bound);
+      if(!(lower_bound<middle_bound)) middle_bound = upper_bound;
+      tpolyhedra_domaint::row_valuet middle = middle_bound.to_expr();
 
       // row_symb_value >= middle
       exprt c = tpolyhedra_domain.get_row_symb_value_constraint(row,middle,true);
@@ -168,8 +190,8 @@ bool strategy_solver_binsearcht::iterate(invariantt &_inv)
       }
 #endif
       
-      lower = simplify_const(
-      	    solver.get(tpolyhedra_domain.get_row_symb_value(row)));
+      lower_bound = numeric_boundt(simplify_const(
+      	    solver.get(tpolyhedra_domain.get_row_symb_value(row))));
       }
       else 
       {
@@ -187,13 +209,14 @@ bool strategy_solver_binsearcht::iterate(invariantt &_inv)
         }
 #endif
 
-        if(!tpolyhedra_domain.less_than(middle,upper)) middle = lower;
-	upper = middle;
+        if(!(middle_bound<upper_bound)) middle_bound = lower_bound;
+	upper_bound = middle_bound;
       }
       solver.pop_context(); // binary search iteration
     }
+    lower = lower_bound.to_expr();
    
-    debug() << "update value: " << from_expr(ns,"",lower) << eom;
+    debug() << "update value: " << lazy_expr(ns,lower) << eom;
 
     solver.pop_context();  //symbolic value system
 
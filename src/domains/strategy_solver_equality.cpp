@@ -3,115 +3,140 @@
 #include <util/simplify_expr.h>
 #include "strategy_solver_equality.h"
 
+/*******************************************************************\
+
+Function: strategy_solver_equalityt::iterate
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: Houdini-style computation of the largest inductive subset
+          of the candidate equalities, then of the candidate
+          disequalities among the rows that are not equalities;
+          every call performs one solver call
+
+\*******************************************************************/
+
 bool strategy_solver_equalityt::iterate(invariantt &_inv) 
 {
   equality_domaint::equ_valuet &inv = 
     static_cast<equality_domaint::equ_valuet &>(_inv);
 
-  worklistt::iterator e_it = todo_equs.begin();
-  if(e_it!=todo_equs.end()) //check equalities
+  if(!todo_equs.empty()) //check equalities
   {
-    solver.new_context();
+    if(refute_candidates(todo_equs,todo_disequs,true))
+      return true;
 
-    exprt pre_expr = equality_domain.get_pre_equ_constraint(*e_it);
-
-    solver << pre_expr;
-    
-    exprt post_expr = equality_domain.get_post_not_equ_constraint(*e_it);
-    literalt cond_literal = solver.convert(post_expr);
-
-    solver << literal_exprt(cond_literal);
+    //the remaining equalities are inductive
+    for(worklistt::const_iterator e_it = todo_equs.begin(); 
+        e_it!=todo_equs.end(); e_it++)
+    {
+      equality_domain.set_equal(*e_it,inv);
+      solver << equality_domain.get_pre_equ_constraint(*e_it); //make permanent
+    }
+    todo_equs.clear();
 
-#if 0
-    debug() << "Checking equality " << eom;
-    debug() << "Pre: " << from_expr(ns, "", pre_expr) << eom;
-    debug() << "Post: " << from_expr(ns, "", post_expr) << eom;
-#endif
+    //rows that are not equalities are candidate disequalities
+    return true;
+  }
 
-    if(solver() == decision_proceduret::D_SATISFIABLE) 
-    { 
-#if 0
-      debug() << "SAT" << eom;
-#endif
-      todo_disequs.insert(*e_it);
+  if(todo_disequs.empty()) return false; //done
 
-      solver.pop_context();
-    }
-    else  //equality holds
-    {
-#if 0
-      debug() << "UNSAT" << eom;
-#endif
-      
-      equality_domain.set_equal(*e_it,inv);
+  worklistt not_disequs;
+  if(refute_candidates(todo_disequs,not_disequs,false))
+    return true;
 
-      solver.pop_context();
+  //the remaining disequalities are inductive
+  for(worklistt::const_iterator e_it = todo_disequs.begin(); 
+      e_it!=todo_disequs.end(); e_it++)
+  {
+    equality_domain.set_disequal(*e_it,inv);
+    solver << equality_domain.get_pre_disequ_constraint(*e_it); 
+  }
+  todo_disequs.clear();
 
-      solver << pre_expr; //make permanent
+  return true;
+}
 
-      //due to transitivity, we would like to recheck equalities that did not hold
-      todo_equs.insert(todo_disequs.begin(),todo_disequs.end());
-      todo_disequs.clear();
-    }
+/*******************************************************************\
 
+Function: strategy_solver_equalityt::refute_candidates
 
-    todo_equs.erase(e_it);
+  Inputs: set of candidate (dis)equalities
 
-    //check status of remaining equalities
-    /*   worklistt rm_equs;
-    for(e_it = todo_equs.begin(); e_it!=todo_equs.end(); e_it++)
-    {
-      equality_domaint::var_pairt vv = equality_domain.get_var_pair(*e_it);
-      if(solver.get(vv.first)!=solver.get(vv.second))
-        rm_equs.insert(*e_it);
-    }
-    for(e_it = rm_equs.begin(); e_it!=rm_equs.end(); e_it++)
-    {
-      todo_disequs.insert(*e_it);
-      todo_equs.erase(*e_it);
-      } */
-  }
-  else //check disequalities
-  {
-    e_it = todo_disequs.begin();
-    if(e_it==todo_disequs.end()) return false; //done
+ Outputs: true if some candidates have been refuted (and moved
+          from candidates to refuted), false if the candidates
+          are inductive
 
-    solver.new_context();
+ Purpose: assumes all candidates in the pre-state and checks
+          whether one of them is violated in the post-state;
+          all candidates violated by the model are refuted at once
 
-    exprt pre_expr = equality_domain.get_pre_disequ_constraint(*e_it);
+\*******************************************************************/
 
-    solver << pre_expr;
-    
-    exprt post_expr = equality_domain.get_post_not_disequ_constraint(*e_it);
-    literalt cond_literal = solver.convert(post_expr);
+bool strategy_solver_equalityt::refute_candidates(
+  worklistt &candidates, 
+  worklistt &refuted,
+  bool equalities)
+{
+  solver.new_context();
+
+  exprt::operandst pre_exprs, post_exprs;
+  bvt cond_literals;
+  pre_exprs.reserve(candidates.size());
+  post_exprs.reserve(candidates.size());
+  cond_literals.reserve(candidates.size());
+  for(worklistt::const_iterator e_it = candidates.begin(); 
+      e_it!=candidates.end(); e_it++)
+  {
+    pre_exprs.push_back(equalities ? 
+      equality_domain.get_pre_equ_constraint(*e_it) :
+      equality_domain.get_pre_disequ_constraint(*e_it));
+
+    exprt post_expr = equalities ? 
+      equality_domain.get_post_not_equ_constraint(*e_it) :
+      equality_domain.get_post_not_disequ_constraint(*e_it);
+    cond_literals.push_back(solver.convert(post_expr));
+    post_exprs.push_back(literal_exprt(cond_literals.back()));
+  }
 
-    solver << literal_exprt(cond_literal);
+  solver << conjunction(pre_exprs);
+  solver << disjunction(post_exprs);
 
 #if 0
-    debug() << "Checking disequality " << eom;
-    debug() << "Pre: " << from_expr(ns, "", pre_expr) << eom;
-    debug() << "Post: " << from_expr(ns, "", post_expr) << eom;
+  debug() << "Checking " << candidates.size() 
+          << (equalities ? " equalities" : " disequalities") << eom;
 #endif
 
-    if(solver() == decision_proceduret::D_SATISFIABLE) 
-    { 
-#if 0
-      debug() << "SAT" << eom;
-#endif      
-    }
-    else  //equality holds
+  if(solver() == decision_proceduret::D_SATISFIABLE) 
+  { 
+    //remove all candidates that are violated by the model
+    unsigned i = 0;
+    for(worklistt::iterator e_it = candidates.begin(); 
+        e_it!=candidates.end(); i++)
     {
-#if 0
-      debug() << "UNSAT" << eom;
-#endif      
-      equality_domain.set_disequal(*e_it,inv);
-      solver << pre_expr; //make permanent
+      if(solver.l_get(cond_literals[i]).is_true())
+      {
+        refuted.insert(*e_it);
+        candidates.erase(e_it++);
+      }
+      else
+        ++e_it;
     }
 
-    solver.pop_context();
+#if 0
+    debug() << "SAT, refuted: " << refuted.size() << eom;
+#endif
 
-    todo_disequs.erase(e_it);
+    solver.pop_context();
+    return true;
   }
 
-  return true;
+#if 0
+  debug() << "UNSAT" << eom;
+#endif
+
+  solver.pop_context();
+  return false;
 }
@@ -25,6 +25,9 @@ class strategy_solver_equalityt : public strategy_solver_baset
   typedef std::set<unsigned> worklistt;
   worklistt todo_equs;
   worklistt todo_disequs;
+
+  bool refute_candidates(worklistt &candidates, worklistt &refuted,
+                         bool equalities);
 };
 
 #endif
@@ -10,6 +10,8 @@ Author: Peter Schrammel
 #include "equality_domain.h"
 #include "tpolyhedra_domain.h"
 #include "predabs_domain.h"
+#include "interval_preanalysis.h"
+#include "profiling.h"
 
 #include <util/find_symbols.h>
 #include <util/arith_tools.h>
@@ -17,6 +19,8 @@ Author: Peter Schrammel
 #include <util/prefix.h>
 #include <util/mp_arith.h>
 
+#include <climits>
+
 #ifdef DEBUG
 #include <iostream>
 #endif
@@ -588,6 +592,307 @@ bool template_generator_baset::instantiate_custom_templates(
 
 /*******************************************************************\
 
+Function: template_generator_baset::filter_constant_vars
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: variables that are constant according to the pre-analysis
+          are bounded precisely by the interval rows; relational
+          rows over them are redundant
+
+\*******************************************************************/
+
+void template_generator_baset::filter_constant_vars(
+  const interval_preanalysist &preanalysis,
+  domaint::var_specst &relational_var_specs)
+{
+  relational_var_specs.clear();
+  for(domaint::var_specst::const_iterator v = var_specs.begin(); 
+      v!=var_specs.end(); v++)
+  {
+    if(v->kind==domaint::LOOP && preanalysis.is_constant(v->var))
+      continue;
+    relational_var_specs.push_back(*v);
+  }
+}
+
+/*******************************************************************\
+
+Function: template_generator_baset::get_dependencies
+
+  Inputs:
+
+ Outputs: deps: template variables the expression depends on
+
+ Purpose: guards are ignored
+
+\*******************************************************************/
+
+void template_generator_baset::get_dependencies(
+  const exprt &expr,
+  const dependenciest &dependencies,
+  indicest &deps)
+{
+  std::set<symbol_exprt> symbols;
+  find_symbols(expr,symbols);
+  for(std::set<symbol_exprt>::const_iterator s_it = symbols.begin();
+      s_it!=symbols.end(); s_it++)
+  {
+    if(s_it->type().id()==ID_bool) continue;
+    dependenciest::const_iterator d_it = 
+      dependencies.find(s_it->get_identifier());
+    if(d_it!=dependencies.end()) 
+      deps.insert(d_it->second.begin(),d_it->second.end());
+  }
+}
+
+/*******************************************************************\
+
+Function: template_generator_baset::select_relational_pairs
+
+  Inputs: rows_per_pair: number of template rows generated per pair
+
+ Outputs: false if all pairs are to be related
+
+ Purpose: relates only variables that flow together into
+          an assignment, a constraint or an assertion;
+          loop variables only if this happens within their loop;
+          with a row budget, the most frequently co-occurring
+          pairs are kept
+
+\*******************************************************************/
+
+bool template_generator_baset::select_relational_pairs(
+  const local_SSAt &SSA,
+  const domaint::var_specst &relational_var_specs,
+  unsigned rows_per_pair,
+  tpolyhedra_domaint::var_pairst &pairs)
+{
+  bool sparse = options.get_bool_option("sparse-relations");
+  unsigned max_rows = options.get_unsigned_int_option("max-relational-rows");
+  if(!sparse && max_rows==0)
+    return false;
+
+  dependenciest dependencies;
+  indicest always_related;
+  for(unsigned i = 0; i<relational_var_specs.size(); i++)
+  {
+    const exprt &var = relational_var_specs[i].var;
+    if(var.id()==ID_symbol)
+      dependencies[to_symbol_expr(var).get_identifier()].insert(i);
+    else
+      always_related.insert(i);
+  }
+
+  // the locations spanned by the loops, 
+  //   identified by the pre-guard of their variables
+  std::map<exprt, std::pair<unsigned,unsigned> > loops;
+  for(local_SSAt::nodest::const_iterator n_it = SSA.nodes.begin();
+      n_it!=SSA.nodes.end(); n_it++)
+  {
+    if(n_it->loophead==SSA.nodes.end()) continue;
+    exprt pre_guard, post_guard;
+    get_pre_post_guards(SSA,n_it,pre_guard,post_guard);
+    loops[pre_guard] = std::make_pair(
+      n_it->loophead->location->location_number,
+      n_it->location->location_number);
+  }
+
+  // forward pass: template variables the SSA symbols depend on
+  std::map<std::pair<unsigned,unsigned>, unsigned> counts;
+  std::vector<indicest> uses;
+  std::vector<unsigned> use_locations;
+  for(local_SSAt::nodest::const_iterator n_it = SSA.nodes.begin();
+      n_it!=SSA.nodes.end(); n_it++)
+  {
+    unsigned location_number = n_it->location->location_number;
+    for(local_SSAt::nodet::equalitiest::const_iterator 
+	  e_it = n_it->equalities.begin(); 
+	e_it!=n_it->equalities.end(); e_it++)
+    {
+      indicest deps;
+      get_dependencies(e_it->rhs(),dependencies,deps);
+      if(e_it->lhs().id()==ID_symbol && !deps.empty())
+      {
+	indicest &lhs_deps =
+	  dependencies[to_symbol_expr(e_it->lhs()).get_identifier()];
+	lhs_deps.insert(deps.begin(),deps.end());
+      }
+      uses.push_back(deps);
+      use_locations.push_back(location_number);
+    }
+    for(local_SSAt::nodet::constraintst::const_iterator 
+	  c_it = n_it->constraints.begin(); 
+	c_it!=n_it->constraints.end(); c_it++)
+    {
+      uses.push_back(indicest());
+      get_dependencies(*c_it,dependencies,uses.back());
+      use_locations.push_back(location_number);
+    }
+    for(local_SSAt::nodet::assertionst::const_iterator 
+	  a_it = n_it->assertions.begin(); 
+	a_it!=n_it->assertions.end(); a_it++)
+    {
+      uses.push_back(indicest());
+      get_dependencies(*a_it,dependencies,uses.back());
+      use_locations.push_back(location_number);
+    }
+  }
+
+  // a variable is related to what flows into its value 
+  //   at the end of the loop body
+  for(unsigned i = 0; i<relational_var_specs.size(); i++)
+  {
+    replace_mapt::const_iterator r_it = 
+      post_renaming_map.find(relational_var_specs[i].var);
+    if(r_it==post_renaming_map.end() || r_it->second.id()!=ID_symbol)
+      continue;
+    dependenciest::const_iterator d_it = 
+      dependencies.find(to_symbol_expr(r_it->second).get_identifier());
+    if(d_it==dependencies.end())
+      continue;
+    uses.push_back(d_it->second);
+    uses.back().insert(i);
+    use_locations.push_back(UINT_MAX); // within the loop
+  }
+
+  for(unsigned u = 0; u<uses.size(); u++)
+  {
+    for(indicest::const_iterator i_it = uses[u].begin();
+	i_it!=uses[u].end(); i_it++)
+    {
+      // relatable loop variables belong to the same loop
+      const domaint::var_spect &var_spec = relational_var_specs[*i_it];
+      if(var_spec.kind==domaint::LOOP && use_locations[u]!=UINT_MAX)
+      {
+	std::map<exprt, std::pair<unsigned,unsigned> >::const_iterator 
+	  l_it = loops.find(var_spec.pre_guard);
+	if(l_it!=loops.end() && 
+	   (use_locations[u]<l_it->second.first || 
+	    use_locations[u]>l_it->second.second))
+	  continue;
+      }
+
+      indicest::const_iterator j_it = i_it; j_it++;
+      for(; j_it!=uses[u].end(); j_it++)
+      {
+	if(tpolyhedra_domaint::is_relatable(var_spec,
+					    relational_var_specs[*j_it]))
+	  counts[std::make_pair(*i_it,*j_it)]++;
+      }
+    }
+  }
+
+  // variables without dependency information are related to all others
+  unsigned number_of_pairs = 0;
+  for(unsigned i = 0; i<relational_var_specs.size(); i++)
+  {
+    for(unsigned j = i+1; j<relational_var_specs.size(); j++)
+    {
+      if(!tpolyhedra_domaint::is_relatable(relational_var_specs[i],
+					   relational_var_specs[j]))
+	continue;
+      number_of_pairs++;
+      std::pair<unsigned,unsigned> pair(i,j);
+      if(!sparse || 
+	 always_related.find(i)!=always_related.end() ||
+	 always_related.find(j)!=always_related.end())
+      {
+	if(counts.find(pair)==counts.end())
+	  counts[pair] = 0;
+      }
+    }
+  }
+
+  if(max_rows==0 || counts.size()*rows_per_pair<=max_rows)
+  {
+    for(std::map<std::pair<unsigned,unsigned>, unsigned>::const_iterator
+	  c_it = counts.begin(); c_it!=counts.end(); c_it++)
+      pairs.insert(c_it->first);
+  }
+  else
+  {
+    // stable: ties are broken by the order of the variables
+    std::multimap<unsigned, std::pair<unsigned,unsigned> > ranking;
+    for(std::map<std::pair<unsigned,unsigned>, unsigned>::const_iterator
+	  c_it = counts.begin(); c_it!=counts.end(); c_it++)
+      ranking.insert(std::make_pair(UINT_MAX-c_it->second,c_it->first));
+    for(std::multimap<unsigned, std::pair<unsigned,unsigned> >::
+	  const_iterator r_it = ranking.begin(); 
+	r_it!=ranking.end() && (pairs.size()+1)*rows_per_pair<=max_rows; 
+	r_it++)
+      pairs.insert(r_it->second);
+  }
+
+  debug() << "Relational templates: " << pairs.size() << " of " 
+	  << number_of_pairs << " variable pairs selected" << eom;
+  return true;
+}
+
+/*******************************************************************\
+
+Function: template_generator_baset::bound_template_rows
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: seed the upper bounds of the row values from the pre-analysis
+
+\*******************************************************************/
+
+void template_generator_baset::bound_template_rows(
+  const interval_preanalysist &preanalysis,
+  tpolyhedra_domaint &domain)
+{
+  unsigned bounded = 0;
+  for(unsigned row = 0; row<domain.template_size(); row++)
+  {
+    const exprt &expr = domain.get_row_expr(row);
+    interval_preanalysist::intervalt interval;
+    if(!preanalysis.get_interval(expr,interval) || interval.bottom)
+      continue;
+    mp_integer max;
+    if(to_integer(domain.get_max_row_value(row),max) || interval.upper>=max)
+      continue;
+    domain.set_row_upper_bound(row,from_integer(interval.upper,expr.type()));
+    bounded++;
+  }
+  debug() << "Interval pre-analysis: " << preanalysis.get_number_of_iterations()
+          << " iteration(s), " << bounded << " of " << domain.template_size()
+          << " template row(s) bounded" << eom;
+}
+
+/*******************************************************************\
+
+Function: template_generator_baset::share_encoding
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: only the symbolic bounds of template polyhedra
+          depend on the domain number
+
+\*******************************************************************/
+
+void template_generator_baset::share_encoding(incremental_solvert &solver)
+{
+  tpolyhedra_domaint *tpolyhedra_domain = 
+    dynamic_cast<tpolyhedra_domaint *>(domain_ptr);
+  if(tpolyhedra_domain==NULL)
+    return;
+
+  irept signature;
+  tpolyhedra_domain->get_signature(signature);
+  domain_number = solver.shared_domain_number(signature);
+  tpolyhedra_domain->set_domain_number(domain_number);
+}
+
+/*******************************************************************\
+
 Function: template_generator_baset::instantiate_standard_domains
 
   Inputs:
@@ -600,8 +905,22 @@ Function: template_generator_baset::instantiate_standard_domains
 
 void template_generator_baset::instantiate_standard_domains(const local_SSAt &SSA)
 {
+  profile_scopet profile_scope("template generation");
+
   replace_mapt &renaming_map =
     std_invariants ? aux_renaming_map : post_renaming_map;
+
+  // cheap interval analysis to prune and bound template rows
+  interval_preanalysist preanalysis(SSA,post_renaming_map,init_renaming_map);
+  bool preanalyzed = false;
+  if(options.get_bool_option("interval-preanalysis") &&
+     !options.get_bool_option("equalities") &&
+     (options.get_bool_option("intervals") ||
+      options.get_bool_option("zones") ||
+      options.get_bool_option("octagons") ||
+      options.get_bool_option("qzones")))
+    preanalyzed = preanalysis();
+  domaint::var_specst relational_var_specs;
   
   //get domain from command line options
   if(options.get_bool_option("equalities"))
@@ -623,8 +942,12 @@ void template_generator_baset::instantiate_standard_domains(const local_SSAt &SS
     domain_ptr = new tpolyhedra_domaint(domain_number,
 					renaming_map);
     filter_template_domain();
+    filter_constant_vars(preanalysis,relational_var_specs);
+    tpolyhedra_domaint::var_pairst pairs;
+    bool selected = 
+      select_relational_pairs(SSA,relational_var_specs,2,pairs);
     static_cast<tpolyhedra_domaint *>(domain_ptr)->add_difference_template(
-      var_specs, SSA.ns);
+      relational_var_specs, SSA.ns, selected ? &pairs : NULL);
     static_cast<tpolyhedra_domaint *>(domain_ptr)->add_interval_template(
       var_specs, SSA.ns);
   }
@@ -633,10 +956,14 @@ void template_generator_baset::instantiate_standard_domains(const local_SSAt &SS
     domain_ptr = new tpolyhedra_domaint(domain_number,
 					renaming_map);
     filter_template_domain();
+    filter_constant_vars(preanalysis,relational_var_specs);
+    tpolyhedra_domaint::var_pairst pairs;
+    bool selected = 
+      select_relational_pairs(SSA,relational_var_specs,4,pairs);
     static_cast<tpolyhedra_domaint *>(domain_ptr)->add_sum_template(
-      var_specs, SSA.ns);
+      relational_var_specs, SSA.ns, selected ? &pairs : NULL);
     static_cast<tpolyhedra_domaint *>(domain_ptr)->add_difference_template(
-      var_specs, SSA.ns);
+      relational_var_specs, SSA.ns, selected ? &pairs : NULL);
     static_cast<tpolyhedra_domaint *>(domain_ptr)->add_interval_template(
       var_specs, SSA.ns);
   }
@@ -650,4 +977,8 @@ void template_generator_baset::instantiate_standard_domains(const local_SSAt &SS
     static_cast<tpolyhedra_domaint *>(domain_ptr)->add_quadratic_template(
       var_specs, SSA.ns);
   }
+
+  if(preanalyzed)
+    bound_template_rows(preanalysis,
+      *static_cast<tpolyhedra_domaint *>(domain_ptr));
 }
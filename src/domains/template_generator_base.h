@@ -15,6 +15,8 @@ Author: Peter Schrammel
 #include "../ssa/local_ssa.h"
 #include "../ssa/ssa_unwinder.h"
 #include "strategy_solver_base.h"
+#include "tpolyhedra_domain.h"
+#include "interval_preanalysis.h"
 
 //#define SHOW_TEMPLATE_VARIABLES
 //#define SHOW_TEMPLATE
@@ -50,6 +52,9 @@ public:
 
   domaint *domain() { assert(domain_ptr!=NULL); return domain_ptr; }
 
+  // reuse the encoding of an identical template used with this solver
+  void share_encoding(incremental_solvert &solver);
+
   domaint::var_specst var_specs;
   replace_mapt post_renaming_map;
   replace_mapt init_renaming_map;
@@ -69,6 +74,19 @@ protected:
 
   void filter_template_domain();
   void filter_equality_domain();
+  void filter_constant_vars(const interval_preanalysist &preanalysis,
+			    domaint::var_specst &relational_var_specs);
+  void bound_template_rows(const interval_preanalysist &preanalysis,
+			   tpolyhedra_domaint &domain);
+  typedef std::set<unsigned> indicest;
+  typedef std::map<irep_idt, indicest> dependenciest;
+  static void get_dependencies(const exprt &expr,
+			       const dependenciest &dependencies,
+			       indicest &deps);
+  bool select_relational_pairs(const local_SSAt &SSA,
+			       const domaint::var_specst &relational_var_specs,
+			       unsigned rows_per_pair,
+			       tpolyhedra_domaint::var_pairst &pairs);
 
   void add_var(const domaint::vart &var_to_add, 			    
 	       const domaint::guardt &pre_guard, 
@@ -68,13 +68,50 @@ void tpolyhedra_domaint::join(valuet &value1, const valuet &value2)
     else if(is_row_value_neginf(v1[row])) v1[row] = v2[row];
     else if(!is_row_value_neginf(v2[row])) 
     {
-      if(less_than(v1[row],v2[row])) v1[row] = v2[row];
+      if(v1[row].type()==v2[row].type() &&
+         numeric_boundt::is_supported(v1[row].type()))
+      {
+        if(v1.get_bound(row)<v2.get_bound(row)) v1[row] = v2[row];
+      }
+      else if(less_than(v1[row],v2[row])) v1[row] = v2[row];
     }
   }
 }
 
 /*******************************************************************\
 
+Function: tpolyhedra_domaint::templ_valuet::get_bound
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: the rows are assigned directly; a cached bound is valid
+          as long as the value and type of the row are unchanged
+
+\*******************************************************************/
+
+const numeric_boundt &tpolyhedra_domaint::templ_valuet::get_bound(
+  unsigned row) const
+{
+  assert(row<size());
+  if(bounds.size()<size()) bounds.resize(size());
+
+  const row_valuet &row_value = (*this)[row];
+  cached_boundt &cached = bounds[row];
+  if(cached.value.empty() || 
+     cached.value!=row_value.get_value() ||
+     cached.type!=row_value.type())
+  {
+    cached.value = row_value.get_value();
+    cached.type = row_value.type();
+    cached.bound = numeric_boundt(row_value);
+  }
+  return cached.bound;
+}
+
+/*******************************************************************\
+
 Function: tpolyhedra_domaint::between
 
   Inputs:
@@ -88,6 +125,13 @@ Function: tpolyhedra_domaint::between
 tpolyhedra_domaint::row_valuet tpolyhedra_domaint::between(
   const row_valuet &lower, const row_valuet &upper)
 {
+#ifndef ENABLE_HEURISTICS
+  if(lower.type()==upper.type() && 
+     numeric_boundt::is_supported(lower.type()))
+    return numeric_boundt::between(
+      numeric_boundt(lower),numeric_boundt(upper)).to_expr();
+#endif
+
   if(lower.type()==upper.type() && 
      (lower.type().id()==ID_signedbv || lower.type().id()==ID_unsignedbv))
   {
@@ -164,6 +208,29 @@ tpolyhedra_domaint::row_valuet tpolyhedra_domaint::between(
 
 /*******************************************************************\
 
+Function: tpolyhedra_domaint::between
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: avoids the conversion from and to constants
+          in each step of the binary search
+
+\*******************************************************************/
+
+numeric_boundt tpolyhedra_domaint::between(
+  const numeric_boundt &lower, const numeric_boundt &upper)
+{
+#ifdef ENABLE_HEURISTICS
+  return numeric_boundt(between(lower.to_expr(),upper.to_expr()));
+#else
+  return numeric_boundt::between(lower,upper);
+#endif
+}
+
+/*******************************************************************\
+
 Function: tpolyhedra_domaint::less_than
 
   Inputs:
@@ -176,14 +243,8 @@ Function: tpolyhedra_domaint::less_than
 
 bool tpolyhedra_domaint::less_than(const row_valuet &v1, const row_valuet &v2)
 {
-  if(v1.type()==v2.type() && 
-     (v1.type().id()==ID_signedbv || v1.type().id()==ID_unsignedbv))
-  {
-    mp_integer vv1, vv2;
-    to_integer(v1, vv1);
-    to_integer(v2, vv2);
-    return vv1<vv2;
-  }
+  if(v1.type()==v2.type() && numeric_boundt::is_supported(v1.type()))
+    return numeric_boundt(v1)<numeric_boundt(v2);
   if(v1.type().id()==ID_floatbv && v2.type().id()==ID_floatbv)
   {
     ieee_floatt vv1(to_constant_expr(v1));
@@ -684,6 +745,48 @@ tpolyhedra_domaint::row_valuet tpolyhedra_domaint::get_min_row_value(
 
 /*******************************************************************\
 
+Function: tpolyhedra_domaint::set_row_upper_bound
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: the row expression never exceeds the given bound
+
+\*******************************************************************/
+
+void tpolyhedra_domaint::set_row_upper_bound(
+  const tpolyhedra_domaint::rowt &row,
+  const tpolyhedra_domaint::row_valuet &bound)
+{
+  assert(row<templ.size());
+  row_upper_bounds[row] = bound;
+}
+
+/*******************************************************************\
+
+Function: tpolyhedra_domaint::get_row_upper_bound
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: smallest known upper bound for the row value,
+          defaults to the maximum value
+
+\*******************************************************************/
+
+tpolyhedra_domaint::row_valuet tpolyhedra_domaint::get_row_upper_bound(
+  const tpolyhedra_domaint::rowt &row)
+{
+  std::map<rowt,row_valuet>::const_iterator it = row_upper_bounds.find(row);
+  if(it!=row_upper_bounds.end())
+    return it->second;
+  return get_max_row_value(row);
+}
+
+/*******************************************************************\
+
 Function: tpolyhedra_domaint::output_value
 
   Inputs:
@@ -778,6 +881,213 @@ unsigned tpolyhedra_domaint::template_size()
 
 /*******************************************************************\
 
+Function: tpolyhedra_domaint::get_signature
+
+  Inputs:
+
+ Outputs: signature: identifies the template up to the domain number
+
+ Purpose:
+
+\*******************************************************************/
+
+void tpolyhedra_domaint::get_signature(irept &signature) const
+{
+  signature = irept("tpolyhedra");
+  irept::subt &rows = signature.get_sub();
+  rows.reserve(templ.size());
+  for(templatet::const_iterator it = templ.begin(); it!=templ.end(); it++)
+  {
+    irept row(i2string(it->kind));
+    row.get_sub().push_back(it->expr);
+    row.get_sub().push_back(it->pre_guard);
+    row.get_sub().push_back(it->post_guard);
+    row.get_sub().push_back(it->aux_expr);
+    rows.push_back(row);
+  }
+}
+
+/*******************************************************************\
+
+Function: remove_unwinding_suffixes
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: x#phi12%2%0 -> x#phi12
+
+\*******************************************************************/
+
+static void remove_unwinding_suffixes(exprt &expr)
+{
+  if(expr.id()==ID_symbol)
+  {
+    symbol_exprt &symbol = to_symbol_expr(expr);
+    const std::string &id = id2string(symbol.get_identifier());
+    std::size_t pos = id.find('%');
+    if(pos!=std::string::npos)
+      symbol.set_identifier(id.substr(0,pos));
+    return;
+  }
+  Forall_operands(it,expr)
+    remove_unwinding_suffixes(*it);
+}
+
+/*******************************************************************\
+
+Function: tpolyhedra_domaint::get_row_key
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: identifies a row independently of the unwinding
+
+\*******************************************************************/
+
+irept tpolyhedra_domaint::get_row_key(const rowt &row) const
+{
+  const template_rowt &templ_row = templ[row];
+  exprt expr = templ_row.expr;
+  exprt pre_guard = templ_row.pre_guard;
+  exprt post_guard = templ_row.post_guard;
+  remove_unwinding_suffixes(expr);
+  remove_unwinding_suffixes(pre_guard);
+  remove_unwinding_suffixes(post_guard);
+
+  irept key(i2string(templ_row.kind));
+  key.get_sub().push_back(expr);
+  key.get_sub().push_back(pre_guard);
+  key.get_sub().push_back(post_guard);
+  return key;
+}
+
+/*******************************************************************\
+
+Function: tpolyhedra_domaint::get_row_values
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: rows that become the same without unwinding suffixes
+          (copies of inner loops) are joined
+
+\*******************************************************************/
+
+void tpolyhedra_domaint::get_row_values(const templ_valuet &value,
+                                        row_value_mapt &row_values)
+{
+  assert(value.size()==templ.size());
+  row_values.clear();
+  std::set<irept> unbounded;
+  for(rowt row = 0; row<templ.size(); row++)
+  {
+    if(is_row_value_neginf(value[row])) 
+      continue;
+    irept key = get_row_key(row);
+    if(is_row_value_inf(value[row]))
+    {
+      unbounded.insert(key);
+      continue;
+    }
+    keyed_row_valuet keyed_value;
+    keyed_value.value = value[row];
+    keyed_value.is_unique = true;
+    std::pair<row_value_mapt::iterator, bool> entry = 
+      row_values.insert(std::make_pair(key,keyed_value));
+    if(!entry.second)
+    {
+      entry.first->second.is_unique = false;
+      if(less_than(entry.first->second.value,value[row]))
+        entry.first->second.value = value[row];
+    }
+  }
+  for(std::set<irept>::const_iterator it = unbounded.begin();
+      it!=unbounded.end(); it++)
+    row_values.erase(*it);
+}
+
+/*******************************************************************\
+
+Function: tpolyhedra_domaint::bound_rows
+
+  Inputs:
+
+ Outputs: number of rows bounded
+
+ Purpose: the bounds are only hints: the binary search
+          falls back to the maximum value if exceeded
+
+\*******************************************************************/
+
+unsigned tpolyhedra_domaint::bound_rows(const row_value_mapt &row_values)
+{
+  if(row_values.empty())
+    return 0;
+  unsigned bounded = 0;
+  for(rowt row = 0; row<templ.size(); row++)
+  {
+    row_value_mapt::const_iterator it = row_values.find(get_row_key(row));
+    if(it==row_values.end() || 
+       it->second.value.type()!=templ[row].expr.type())
+      continue;
+    if(less_than(it->second.value,get_row_upper_bound(row)))
+    {
+      set_row_upper_bound(row,it->second.value);
+      bounded++;
+    }
+  }
+  return bounded;
+}
+
+/*******************************************************************\
+
+Function: tpolyhedra_domaint::get_row_value_invariant
+
+  Inputs:
+
+ Outputs: /\_loop_rows ( pre_guard ==> (row_expr <= row_value) )
+
+ Purpose: renames the invariant of the previous unwinding for
+          this one: the looping copy of a loop in the previous 
+          unwinding corresponds to the looping copy in this one
+
+\*******************************************************************/
+
+exprt tpolyhedra_domaint::get_row_value_invariant(
+  const row_value_mapt &row_values)
+{
+  if(row_values.empty())
+    return true_exprt();
+
+  std::map<irept, unsigned> key_count;
+  std::vector<irept> keys(templ.size());
+  for(rowt row = 0; row<templ.size(); row++)
+  {
+    keys[row] = get_row_key(row);
+    key_count[keys[row]]++;
+  }
+
+  exprt::operandst c;
+  for(rowt row = 0; row<templ.size(); row++)
+  {
+    const template_rowt &templ_row = templ[row];
+    if(templ_row.kind!=LOOP || key_count[keys[row]]!=1)
+      continue;
+    row_value_mapt::const_iterator it = row_values.find(keys[row]);
+    if(it==row_values.end() || !it->second.is_unique ||
+       it->second.value.type()!=templ_row.expr.type())
+      continue;
+    c.push_back(implies_exprt(templ_row.pre_guard,
+      binary_relation_exprt(templ_row.expr,ID_le,it->second.value)));
+  }
+  return conjunction(c);
+}
+
+/*******************************************************************\
+
 Function: tpolyhedra_domaint::is_row_value_neginf
 
   Inputs:
@@ -906,6 +1216,27 @@ void tpolyhedra_domaint::add_interval_template(const var_specst &var_specs,
 
 /*******************************************************************\
 
+Function: tpolyhedra_domaint::is_relatable
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: whether relational rows are generated for the pair
+
+\*******************************************************************/
+
+bool tpolyhedra_domaint::is_relatable(const var_spect &v1, 
+                                      const var_spect &v2)
+{
+  kindt k = domaint::merge_kinds(v1.kind,v2.kind);
+  if(k==IN) return false; 
+  if(k==LOOP && v1.pre_guard!=v2.pre_guard) return false; //TEST: we need better heuristics
+  return true;
+}
+
+/*******************************************************************\
+
 Function: add_difference_template
 
   Inputs:
@@ -917,31 +1248,34 @@ Function: add_difference_template
 \*******************************************************************/
 
 void tpolyhedra_domaint::add_difference_template(const var_specst &var_specs,
-					 const namespacet &ns)
+					 const namespacet &ns,
+					 const var_pairst *pairs)
 { 
-  unsigned size = var_specs.size()*(var_specs.size()-1);
+  unsigned size = pairs!=NULL ? 2*pairs->size() : 
+    var_specs.size()*(var_specs.size()-1);
   templ.reserve(templ.size()+size);
   
-  for(var_specst::const_iterator v1 = var_specs.begin(); 
-      v1!=var_specs.end(); v1++)
+  for(unsigned i = 0; i<var_specs.size(); i++)
   {
-    var_specst::const_iterator v2 = v1; v2++;
-    for(; v2!=var_specs.end(); v2++)
+    for(unsigned j = i+1; j<var_specs.size(); j++)
     {
-      kindt k = domaint::merge_kinds(v1->kind,v2->kind);
-      if(k==IN) continue; 
-      if(k==LOOP && v1->pre_guard!=v2->pre_guard) continue; //TEST: we need better heuristics
+      const var_spect &v1 = var_specs[i];
+      const var_spect &v2 = var_specs[j];
+      if(!is_relatable(v1,v2)) continue;
+      if(pairs!=NULL && pairs->find(std::make_pair(i,j))==pairs->end()) 
+        continue;
 
+      kindt k = domaint::merge_kinds(v1.kind,v2.kind);
       exprt pre_g, post_g, aux_expr;
-      merge_and(pre_g, v1->pre_guard, v2->pre_guard, ns);
-      merge_and(post_g, v1->post_guard, v2->post_guard, ns);
-      merge_and(aux_expr, v1->aux_expr, v2->aux_expr, ns);
+      merge_and(pre_g, v1.pre_guard, v2.pre_guard, ns);
+      merge_and(post_g, v1.post_guard, v2.post_guard, ns);
+      merge_and(aux_expr, v1.aux_expr, v2.aux_expr, ns);
 
       // x1 - x2
-      add_template_row(minus_exprt(v1->var,v2->var),pre_g,post_g,aux_expr,k);
+      add_template_row(minus_exprt(v1.var,v2.var),pre_g,post_g,aux_expr,k);
 
       // x2 - x1
-      add_template_row(minus_exprt(v2->var,v1->var),pre_g,post_g,aux_expr,k);
+      add_template_row(minus_exprt(v2.var,v1.var),pre_g,post_g,aux_expr,k);
     }
   }
 }
@@ -991,32 +1325,35 @@ Function: add_sum_template
 \*******************************************************************/
 
 void tpolyhedra_domaint::add_sum_template(const var_specst &var_specs,
-					    const namespacet &ns)
+					    const namespacet &ns,
+					    const var_pairst *pairs)
 {
-  unsigned size = var_specs.size()*(var_specs.size()-1);
+  unsigned size = pairs!=NULL ? 2*pairs->size() : 
+    var_specs.size()*(var_specs.size()-1);
   templ.reserve(templ.size()+size);
   
-  for(var_specst::const_iterator v1 = var_specs.begin(); 
-      v1!=var_specs.end(); v1++)
+  for(unsigned i = 0; i<var_specs.size(); i++)
   {
-    var_specst::const_iterator v2 = v1; v2++;
-    for(; v2!=var_specs.end(); v2++)
+    for(unsigned j = i+1; j<var_specs.size(); j++)
     {
-      kindt k = domaint::merge_kinds(v1->kind,v2->kind);
-      if(k==IN) continue; 
-      if(k==LOOP && v1->pre_guard!=v2->pre_guard) continue; //TEST: we need better heuristics
+      const var_spect &v1 = var_specs[i];
+      const var_spect &v2 = var_specs[j];
+      if(!is_relatable(v1,v2)) continue;
+      if(pairs!=NULL && pairs->find(std::make_pair(i,j))==pairs->end()) 
+        continue;
 
+      kindt k = domaint::merge_kinds(v1.kind,v2.kind);
       exprt pre_g, post_g, aux_expr;
-      merge_and(pre_g, v1->pre_guard, v2->pre_guard, ns);
-      merge_and(post_g, v1->post_guard, v2->post_guard, ns);
-      merge_and(aux_expr, v1->aux_expr, v2->aux_expr, ns);
+      merge_and(pre_g, v1.pre_guard, v2.pre_guard, ns);
+      merge_and(post_g, v1.post_guard, v2.post_guard, ns);
+      merge_and(aux_expr, v1.aux_expr, v2.aux_expr, ns);
 
       // -x1 - x2
-      add_template_row(minus_exprt(unary_minus_exprt(v1->var,v1->var.type()),v2->var),
+      add_template_row(minus_exprt(unary_minus_exprt(v1.var,v1.var.type()),v2.var),
 		       pre_g,post_g,aux_expr,k);
 
       // x1 + x2
-      add_template_row(plus_exprt(v1->var,v2->var),pre_g,post_g,aux_expr,k);
+      add_template_row(plus_exprt(v1.var,v2.var),pre_g,post_g,aux_expr,k);
     }
   }
 
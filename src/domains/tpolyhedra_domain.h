@@ -2,11 +2,13 @@
 #define CPROVER_TEMPLATE_DOMAIN_H
 
 #include "domain.h"
+#include "numeric_bound.h"
 
 #include <util/std_expr.h>
 #include <util/arith_tools.h>
 #include <util/ieee_float.h>
 #include <set>
+#include <map>
 
 class tpolyhedra_domaint : public domaint
 {
@@ -17,6 +19,18 @@ public:
 
   class templ_valuet : public domaint::valuet, public std::vector<row_valuet> 
   {
+  public:
+    // the row value as a number, parsed once per assigned value
+    const numeric_boundt &get_bound(unsigned row) const;
+
+  protected:
+    struct cached_boundt
+    {
+      irep_idt value;
+      typet type;
+      numeric_boundt bound;
+    };
+    mutable std::vector<cached_boundt> bounds;
   };
 
   typedef struct 
@@ -72,9 +86,15 @@ public:
   row_valuet get_min_row_value(const rowt &row);
   row_valuet between(const row_valuet &lower, const row_valuet &upper);
   bool less_than(const row_valuet &v1, const row_valuet &v2);
+  numeric_boundt between(const numeric_boundt &lower, 
+                         const numeric_boundt &upper);
   bool is_row_value_inf(const row_valuet & row_value) const;
   bool is_row_value_neginf(const row_valuet & row_value) const;
 
+  // upper bounds on the row values known beforehand (e.g. by pre-analysis)
+  void set_row_upper_bound(const rowt &row, const row_valuet &bound);
+  row_valuet get_row_upper_bound(const rowt &row);
+
   // printing
   virtual void output_value(std::ostream &out, const valuet &value, const namespacet &ns) const;
   virtual void output_domain(std::ostream &out, const namespacet &ns) const;
@@ -83,6 +103,22 @@ public:
   virtual void project_on_vars(valuet &value, const var_sett &vars, exprt &result);
 
   unsigned template_size();
+  void get_signature(irept &signature) const;
+
+  // row values by rows with unwinding suffixes removed,
+  //   to carry bounds over to the next unwinding
+  typedef struct
+  {
+    row_valuet value;
+    bool is_unique; // not joined from several copies of a loop
+  } keyed_row_valuet;
+  typedef std::map<irept, keyed_row_valuet> row_value_mapt;
+  void get_row_values(const templ_valuet &value, 
+                      row_value_mapt &row_values);
+  unsigned bound_rows(const row_value_mapt &row_values);
+  // the loop invariant given by the row values, on the rows 
+  //   that correspond to exactly one row of the previous unwinding
+  exprt get_row_value_invariant(const row_value_mapt &row_values);
 
   // generating templates
   template_rowt &add_template_row(
@@ -95,14 +131,22 @@ public:
 
   void add_interval_template(const var_specst &var_specs,
 			      const namespacet &ns);
+  // pairs (i,j), i<j, of indices into the var_specs;
+  //   NULL: all pairs
+  typedef std::set<std::pair<unsigned,unsigned> > var_pairst;
+  static bool is_relatable(const var_spect &v1, const var_spect &v2);
   void add_difference_template(const var_specst &var_specs,
-				 const namespacet &ns);
+				 const namespacet &ns,
+				 const var_pairst *pairs=NULL);
   void add_sum_template(const var_specst &var_specs,
-				    const namespacet &ns);
+				    const namespacet &ns,
+				    const var_pairst *pairs=NULL);
   void add_quadratic_template(const var_specst &var_specs,
 				    const namespacet &ns);
 
   symbol_exprt get_row_symb_value(const rowt &row);
+  const row_exprt &get_row_expr(const rowt &row) const 
+    { return templ[row].expr; }
 
   void rename_for_row(exprt &expr, const rowt &row);
 
@@ -111,6 +155,9 @@ protected:
   friend class strategy_solver_enumerationt;
 
   templatet templ;
+  std::map<rowt,row_valuet> row_upper_bounds;
+
+  irept get_row_key(const rowt &row) const;
   
 };
 
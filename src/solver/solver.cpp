@@ -36,7 +36,11 @@ Function: solvert::solvert
 
 \*******************************************************************/
 
-solvert::solvert(const namespacet &_ns):decision_proceduret(_ns)
+solvert::solvert(const namespacet &_ns):
+  decision_proceduret(_ns),
+  inconsistent(false),
+  false_nr(0),
+  true_nr(0)
 {
   false_nr=add(false_exprt());
   true_nr=add(true_exprt());
@@ -100,7 +104,11 @@ unsigned solvert::add_rec(const exprt &expr)
   unsigned nr=expr_numbering(expr);
   
   // new? do recursion
-  if(expr_numbering.size()!=old_size) new_expression(nr);
+  if(expr_numbering.size()!=old_size)
+  {
+    init_node(nr);
+    new_expression(nr);
+  }
 
   return nr;
 }
@@ -132,6 +140,33 @@ bool solvert::is_equal(const exprt &a, const exprt &b) const
 
 /*******************************************************************\
 
+Function: solvert::init_node
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void solvert::init_node(unsigned nr)
+{
+  // references into these aren't stable, thus enlarge now
+  if(expr_map.size()<=nr)
+  {
+    expr_map.resize(nr+1);
+    integer_intervals.resize(nr+1);
+    ieee_float_intervals.resize(nr+1);
+  }
+
+  solver_exprt &se=expr_map[nr];
+  se.parent=nr;
+  se.members.push_back(nr);
+}
+
+/*******************************************************************\
+
 Function: solvert::add_operands
 
   Inputs:
@@ -156,12 +191,13 @@ void solvert::add_operands(unsigned nr)
   for(unsigned i=0; i<dest.size(); i++)
     dest[i]=add_rec(expr_op[i]);
 
-  // store    
+  // store
   expr_map[nr].op=dest;
 
-  // Remember that the operands are contained in the expresion.
-  for(unsigned i=0; i<dest.size(); i++)
-    expr_map[dest[i]].operand_of.push_back(nr);
+  // the function symbol is the expression without operands
+  exprt function=expr;
+  function.operands().clear();
+  expr_map[nr].function_nr=function_numbering(function);
 }
 
 /*******************************************************************\
@@ -180,64 +216,140 @@ void solvert::new_expression(unsigned nr)
 {
   // expr_numbering is a vector, and thus not stable.
   const exprt expr=expr_numbering[nr];
-      
-  if(expr.id()==ID_if)
+
+  if(expr.id()==ID_address_of)
   {
-    add_operands(nr);
-    if_list.push_back(nr);
-    
-    // we also add if-s as UFs (uff!)
-    uf_map[ID_if].push_back(nr);
+    // NOT an uninterpreted function, but rather a constant.
   }
-  else if(expr.id()==ID_or)
+  else if(expr.id()==ID_notequal)
   {
-    add_operands(nr);
-    or_list.push_back(nr);
+    // handled by an axiom, see register_node
   }
-  else if(expr.id()==ID_and)
+  else if(expr.has_operands())
   {
+    // if, or, and, not, equal are interpreted,
+    // everything else is uninterpreted;
+    // congruence holds for all of them
     add_operands(nr);
-    and_list.push_back(nr);
+
+    #ifdef DEBUG
+    std::cout << "UF " << nr << " added: " << expr.id();
+    for(unsigned i=0; i<expr_map[nr].op.size(); i++)
+      std::cout << " " << expr_map[nr].op[i];
+    std::cout << "\n";
+    #endif
   }
-  else if(expr.id()==ID_not)
+
+  register_node(nr);
+}
+
+/*******************************************************************\
+
+Function: solvert::register_node
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: Adds the expression to the use lists of its operands and
+          to the signature table, and asserts the axioms that come
+          with it. This is redone on pop() for expressions that
+          have been added after the matching push().
+
+\*******************************************************************/
+
+void solvert::register_node(unsigned nr)
+{
+  // expr_numbering is a vector, and thus not stable.
+  const exprt expr=expr_numbering[nr];
+
+  if(expr.id()==ID_notequal)
   {
-    add_operands(nr);
-    not_list.push_back(nr);
+    // we record x!=y <=> !x==y
+    set_equal(add(not_exprt(equal_exprt(expr.op0(), expr.op1()))), nr);
+    return;
   }
-  else if(expr.id()==ID_notequal)
+
+  if(expr.is_constant())
   {
-    // we record x!=y <=> !x==y
-    set_equal(not_exprt(equal_exprt(expr.op0(), expr.op1())),
-              expr);
+    bound(to_constant_expr(expr), nr, WEAK, LOWER);
+    bound(to_constant_expr(expr), nr, WEAK, UPPER);
+    return;
   }
-  else if(expr.id()==ID_equal)
+
+  const std::vector<unsigned> &op=expr_map[nr].op;
+  if(op.empty()) return;
+
+  for(unsigned i=0; i<op.size(); i++)
   {
-    add_operands(nr);
-    equal_list.push_back(nr);
+    unsigned root=find(op[i]);
+    expr_map[root].use_list.push_back(nr);
+    trail.push_back(trail_entryt(trail_entryt::USE, root));
   }
-  else if(expr.id()==ID_address_of)
+
+  update_signature(nr);
+  todo.push_back(nr);
+}
+
+/*******************************************************************\
+
+Function: solvert::get_signature
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void solvert::get_signature(unsigned nr, signaturet &signature) const
+{
+  const solver_exprt &se=expr_map[nr];
+  signature.resize(se.op.size()+1);
+  signature[0]=se.function_nr;
+  for(unsigned i=0; i<se.op.size(); i++)
+    signature[i+1]=find(se.op[i]);
+}
+
+/*******************************************************************\
+
+Function: solvert::update_signature
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void solvert::update_signature(unsigned nr)
+{
+  signaturet signature;
+  get_signature(nr, signature);
+
+  std::pair<signature_tablet::iterator, bool> entry=
+    signature_table.insert(std::make_pair(signature, nr));
+
+  if(entry.second)
   {
-    // NOT an uninterpreted function, but rather a constant.
+    signature_trail.push_back(signature);
+    trail.push_back(trail_entryt(trail_entryt::SIGNATURE));
   }
-  else
+  else if(!is_equal(entry.first->second, nr))
   {
-    if(expr.has_operands()) // make it uninterpreted
-    {
-      add_operands(nr);
-      uf_map[expr.id()].push_back(nr);
-      
-      #ifdef DEBUG
-      std::cout << "UF " << nr << " added: " << expr.id();
-      forall_operands(it, expr) std::cout << " " << add(*it);
-      std::cout << "\n";
-      #endif
-    }
+    #ifdef DEBUG
+    std::cout << "UF check: "
+              << entry.first->second << " = " << nr << "\n";
+    #endif
+    pending.push_back(std::make_pair(entry.first->second, nr));
   }
 }
 
 /*******************************************************************\
 
-Function: solvert::dec_solve
+Function: solvert::class_value
 
   Inputs:
 
@@ -247,381 +359,520 @@ Function: solvert::dec_solve
 
 \*******************************************************************/
 
-decision_proceduret::resultt solvert::dec_solve()
+tvt solvert::class_value(unsigned root) const
 {
-  bool progress;
-  
-  do
-  {  
-    progress=false;
-    
-    // rummage through things that are equal to 'true'
-    // and that we haven't processed yet
+  if(find(true_nr)==root) return tvt(true);
+  if(find(false_nr)==root) return tvt(false);
+  return tvt::unknown();
+}
 
-    for(unsigned i=0; i<equalities.size(); i++)
-    {
-      if(!is_true(i)) continue;
-      if(expr_map[i].predicate_processed) continue;
-
-      // remember we have done it
-      expr_map[i].predicate_processed=true;
-      
-      const exprt &expr=expr_numbering[i];
-      
-      #ifdef DEBUG
-      std::cout << "RUMMAGE true: " << from_expr(ns, "", expr) << std::endl;
-      #endif
-      
-      if(expr.id()==ID_equal)
-      {
-        const equal_exprt &equal_expr=to_equal_expr(expr);
-        const exprt &lhs=equal_expr.lhs();
-        const exprt &rhs=equal_expr.rhs();
-      
-        implies_equal(add(lhs), add(rhs), progress);
-      }
-      else if(expr.id()==ID_le)
-      {
-        assert(expr.operands().size()==2);
-        
-        if(expr.op0().is_constant()) // c <= something
-          bound(to_constant_expr(expr.op0()), expr.op1(), WEAK, LOWER, progress);
-        else if(expr.op1().is_constant()) // something <= c
-          bound(to_constant_expr(expr.op1()), expr.op0(), WEAK, UPPER, progress);
-      }
-      else if(expr.id()==ID_lt)
-      {
-        if(expr.op0().is_constant()) // c < something
-          bound(to_constant_expr(expr.op0()), expr.op1(), STRICT, LOWER, progress);
-        else if(expr.op1().is_constant()) // something < c
-          bound(to_constant_expr(expr.op1()), expr.op0(), STRICT, UPPER, progress);
-      }
-    }
+/*******************************************************************\
 
-    // rummage through things that are equal to 'false'
-    // and that we haven't processed yet
+Function: solvert::set_inconsistent
 
-    for(unsigned i=0; i<equalities.size(); i++)
-    {
-      if(!is_false(i)) continue;
-      if(expr_map[i].predicate_processed) continue;
-
-      // remember we have done it
-      expr_map[i].predicate_processed=true;
-      
-      const exprt &expr=expr_numbering[i];
-      
-      #ifdef DEBUG
-      std::cout << "RUMMAGE false: " << from_expr(ns, "", expr) << std::endl;
-      #endif
-      
-      if(expr.id()==ID_equal)
-      {
-        const equal_exprt &equal_expr=to_equal_expr(expr);
-        const exprt &lhs=equal_expr.lhs();
-        const exprt &rhs=equal_expr.rhs();
-      
-        implies_disequal(add(lhs), add(rhs), progress);
-      }
-      else if(expr.id()==ID_le)
-      {
-        assert(expr.operands().size()==2);
-        
-        if(expr.op0().is_constant()) // ! c <= something
-          bound(to_constant_expr(expr.op0()), expr.op1(), STRICT, UPPER, progress);
-        else if(expr.op1().is_constant()) // ! something <= c
-          bound(to_constant_expr(expr.op1()), expr.op0(), STRICT, LOWER, progress);
-      }
-      else if(expr.id()==ID_lt)
-      {
-        if(expr.op0().is_constant()) // ! c < something
-          bound(to_constant_expr(expr.op0()), expr.op1(), WEAK, UPPER, progress);
-        else if(expr.op1().is_constant()) // ! something < c
-          bound(to_constant_expr(expr.op1()), expr.op0(), WEAK, LOWER, progress);
-      }
-    }
+  Inputs:
 
-    // Add bounds around constants.
-    for(unsigned i=0; i<expr_numbering.size(); i++)
-    {
-      const exprt &e=expr_numbering[i];
-      if(e.is_constant())
-      {
-        bound(to_constant_expr(e), e, WEAK, LOWER, progress);
-        bound(to_constant_expr(e), e, WEAK, UPPER, progress);
-      }
-    }
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void solvert::set_inconsistent()
+{
+  if(inconsistent) return;
+  inconsistent=true;
+  trail.push_back(trail_entryt(trail_entryt::INCONSISTENT));
+}
+
+/*******************************************************************\
+
+Function: solvert::merge
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: union by size; the rules of the expressions that
+          are affected by the merge are queued
 
-    // Rummage through things that are equal,
-    // and make the bounds meet. Should really use triggers for this.
+\*******************************************************************/
+
+void solvert::merge(unsigned a, unsigned b)
+{
+  unsigned r=find(a), s=find(b);
+  if(r==s) return;
+
+  // merge the smaller class 's' into 'r'
+  if(expr_map[r].members.size()<expr_map[s].members.size())
+    std::swap(r, s);
+
+  tvt r_value=class_value(r), s_value=class_value(s);
+
+  solver_exprt &r_se=expr_map[r];
+  solver_exprt &s_se=expr_map[s];
 
-    // References below aren't stable, thus enlarge now!
-    integer_intervals[expr_numbering.size()-1];
-    ieee_float_intervals[expr_numbering.size()-1];
+  unsigned r_members=r_se.members.size();
+  unsigned r_uses=r_se.use_list.size();
+
+  trail.push_back(trail_entryt(trail_entryt::MERGE, s, r_uses));
+  s_se.parent=r;
+  r_se.members.insert(r_se.members.end(),
+                      s_se.members.begin(), s_se.members.end());
+
+  // the operands of the users of 's' have changed
+  for(unsigned i=0; i<s_se.use_list.size(); i++)
+  {
+    update_signature(s_se.use_list[i]);
+    todo.push_back(s_se.use_list[i]);
+  }
+  r_se.use_list.insert(r_se.use_list.end(),
+                       s_se.use_list.begin(), s_se.use_list.end());
+
+  // the truth value of one side may have changed
+  if(!r_value.is_unknown() && !s_value.is_unknown())
+  {
+    // true==false
+    set_inconsistent();
+    return;
+  }
+  else if(r_value.is_unknown() && !s_value.is_unknown())
+  {
+    for(unsigned i=0; i<r_members; i++)
+      todo.push_back(r_se.members[i]);
+    for(unsigned i=0; i<r_uses; i++)
+      todo.push_back(r_se.use_list[i]);
+  }
+  else if(s_value.is_unknown() && !r_value.is_unknown())
+  {
+    for(unsigned i=0; i<s_se.members.size(); i++)
+      todo.push_back(s_se.members[i]);
+  }
 
-    for(unsigned i=0; i<expr_numbering.size(); i++)
+  // disequalities are kept for roots only
+  for(std::set<unsigned>::const_iterator
+      d_it=s_se.disequal.begin();
+      d_it!=s_se.disequal.end();
+      d_it++)
+  {
+    unsigned d=find(*d_it);
+    if(d==s || d==r)
     {
-      unsigned root=equalities.find(i);
-      if(root==i) continue;
-      if(integer_intervals[root].meet(integer_intervals[i])) progress=true;
-      if(integer_intervals[i].meet(integer_intervals[root])) progress=true;
-      if(ieee_float_intervals[root].meet(ieee_float_intervals[i])) progress=true;
-      if(ieee_float_intervals[i].meet(ieee_float_intervals[root])) progress=true;
+      set_inconsistent();
+      return;
     }
+    add_disequality(r, d);
+  }
 
-    for(solver_expr_listt::const_iterator
-        if_it=if_list.begin();
-        if_it!=if_list.end();
-        if_it++)
-    {
-      unsigned e_nr=*if_it;
-      const solver_exprt &se=expr_map[e_nr];
+  // the intervals
+  meet_intervals(r, integer_intervals[s], ieee_float_intervals[s]);
+}
 
-      if(is_false(se.op[0])) // false ? x : y == y
-      {
-        implies_equal(se.op[2], e_nr, progress);
-      }
-      else if(is_true(se.op[0])) // true ? x : y == x
-      {
-        implies_equal(se.op[1], e_nr, progress);
-      }
+/*******************************************************************\
 
-      if(is_equal(se.op[2], se.op[1])) // c ? x : x == x
-      {
-        implies_equal(se.op[2], e_nr, progress);
-      }
-    }
-    
-    for(solver_expr_listt::const_iterator
-        or_it=or_list.begin();
-        or_it!=or_list.end();
-        or_it++)
-    {
-      unsigned e_nr=*or_it;
-      const solver_exprt &se=expr_map[e_nr];
+Function: solvert::is_disequal
 
-      if(is_false(se.op[1])) // x || false == x
-      {
-        implies_equal(se.op[0], e_nr, progress);
-      }
+  Inputs:
 
-      if(is_false(se.op[0])) // false || x == x
-      {
-        implies_equal(se.op[1], e_nr, progress);
-      }
+ Outputs:
 
-      if(is_true(se.op[1])) // x || true == true
-      {
-        implies_equal(true_nr, e_nr, progress);
-      }
+ Purpose:
 
-      if(is_true(se.op[0])) // true || x == true
-      {
-        implies_equal(true_nr, e_nr, progress);
-      }
+\*******************************************************************/
 
-      if(is_false(e_nr)) // !(x || y) ===> !x, !y
-      {
-        for(unsigned i=0; i<se.op.size(); i++)
-          implies_equal(se.op[i], false_nr, progress);
-      }
-    }
+bool solvert::is_disequal(unsigned a, unsigned b) const
+{
+  unsigned ra=find(a), rb=find(b);
+  const std::set<unsigned> &da=expr_map[ra].disequal;
+  const std::set<unsigned> &db=expr_map[rb].disequal;
+  if(da.size()<=db.size())
+    return da.find(rb)!=da.end();
+  else
+    return db.find(ra)!=db.end();
+}
 
-    for(solver_expr_listt::const_iterator
-        and_it=and_list.begin();
-        and_it!=and_list.end();
-        and_it++)
-    {
-      unsigned e_nr=*and_it;
-      const solver_exprt &se=expr_map[e_nr];
+/*******************************************************************\
 
-      if(is_true(se.op[1])) // x && true == x
-      {
-        implies_equal(se.op[0], e_nr, progress);
-      }
-      
-      if(is_true(se.op[0])) // true && x == x
-      {
-        implies_equal(se.op[1], e_nr, progress);
-      }
+Function: solvert::add_disequality
 
-      if(is_false(se.op[1])) // x && false == false
-      {
-        implies_equal(false_nr, e_nr, progress);
-      }
-      
-      if(is_false(se.op[0])) // false && x == false
-      {
-        implies_equal(false_nr, e_nr, progress);
-      }
+  Inputs: two roots
 
-      if(is_true(e_nr)) // a && b == true -> a==true && b==true
-      {
-        for(std::vector<unsigned>::const_iterator
-            o_it=se.op.begin(); o_it!=se.op.end(); o_it++)
-          implies_equal(*o_it, true_nr, progress);
-      }
-    }
+ Outputs:
 
-    for(solver_expr_listt::const_iterator
-        not_it=not_list.begin();
-        not_it!=not_list.end();
-        not_it++)
-    {
-      unsigned e_nr=*not_it;
-      const solver_exprt &se=expr_map[e_nr];
+ Purpose:
 
-      if(is_true(se.op[0])) // !true == false
-      {
-        implies_equal(false_nr, e_nr, progress);
-      }
-      else if(is_false(se.op[0])) // !false == true
-      {
-        implies_equal(true_nr, e_nr, progress);
-      }
+\*******************************************************************/
+
+void solvert::add_disequality(unsigned root1, unsigned root2)
+{
+  if(root1==root2)
+  {
+    set_inconsistent();
+    return;
+  }
+
+  if(!expr_map[root1].disequal.insert(root2).second)
+    return; // known already
+
+  trail.push_back(trail_entryt(trail_entryt::DISEQUAL, root1, root2));
+  expr_map[root2].disequal.insert(root1);
+  trail.push_back(trail_entryt(trail_entryt::DISEQUAL, root2, root1));
+
+  // equalities between the two classes have become false
+  const std::vector<unsigned> &use_list=
+    expr_map[root1].use_list.size()<=expr_map[root2].use_list.size() ?
+    expr_map[root1].use_list : expr_map[root2].use_list;
+
+  for(unsigned i=0; i<use_list.size(); i++)
+    if(expr_numbering[use_list[i]].id()==ID_equal)
+      todo.push_back(use_list[i]);
+}
+
+/*******************************************************************\
+
+Function: solvert::meet_intervals
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void solvert::meet_intervals(
+  unsigned root,
+  const integer_intervalt &integer_interval,
+  const ieee_float_intervalt &ieee_float_interval)
+{
+  integer_intervalt new_integer_interval=integer_intervals[root];
+  ieee_float_intervalt new_ieee_float_interval=ieee_float_intervals[root];
+
+  bool changed=new_integer_interval.meet(integer_interval);
+  if(new_ieee_float_interval.meet(ieee_float_interval)) changed=true;
+
+  if(!changed) return;
+
+  interval_trail.push_back(
+    std::make_pair(integer_intervals[root], ieee_float_intervals[root]));
+  trail.push_back(trail_entryt(trail_entryt::INTERVAL, root));
+
+  integer_intervals[root]=new_integer_interval;
+  ieee_float_intervals[root]=new_ieee_float_interval;
+
+  if(new_integer_interval.is_bottom() ||
+     new_ieee_float_interval.is_bottom())
+    set_inconsistent();
+}
+
+/*******************************************************************\
+
+Function: solvert::process_predicate
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: a predicate has become true or false
+
+\*******************************************************************/
+
+void solvert::process_predicate(unsigned nr, bool value)
+{
+  // remember we have done it
+  expr_map[nr].predicate_processed=true;
+  trail.push_back(trail_entryt(trail_entryt::PROCESSED, nr));
+
+  // expr_numbering is a vector, and thus not stable.
+  const exprt expr=expr_numbering[nr];
+  const std::vector<unsigned> op=expr_map[nr].op;
+
+  #ifdef DEBUG
+  std::cout << "RUMMAGE " << (value?"true":"false") << ": "
+            << from_expr(ns, "", expr) << std::endl;
+  #endif
+
+  if(expr.id()==ID_equal)
+  {
+    if(value)
+      implies_equal(op[0], op[1]);
+    else
+      implies_disequal(op[0], op[1]);
+  }
+  else if(expr.id()==ID_le)
+  {
+    assert(op.size()==2);
+
+    if(expr.op0().is_constant()) // c <= something
+      bound(to_constant_expr(expr.op0()), op[1],
+            value?WEAK:STRICT, value?LOWER:UPPER);
+    else if(expr.op1().is_constant()) // something <= c
+      bound(to_constant_expr(expr.op1()), op[0],
+            value?WEAK:STRICT, value?UPPER:LOWER);
+  }
+  else if(expr.id()==ID_lt)
+  {
+    assert(op.size()==2);
+
+    if(expr.op0().is_constant()) // c < something
+      bound(to_constant_expr(expr.op0()), op[1],
+            value?STRICT:WEAK, value?LOWER:UPPER);
+    else if(expr.op1().is_constant()) // something < c
+      bound(to_constant_expr(expr.op1()), op[0],
+            value?STRICT:WEAK, value?UPPER:LOWER);
+  }
+}
+
+/*******************************************************************\
+
+Function: solvert::check_node
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: evaluates the rules of the given expression
+
+\*******************************************************************/
+
+void solvert::check_node(unsigned nr)
+{
+  if(!expr_map[nr].predicate_processed)
+  {
+    if(is_true(nr))
+      process_predicate(nr, true);
+    else if(is_false(nr))
+      process_predicate(nr, false);
+  }
+
+  const irep_idt &id=expr_numbering[nr].id();
+  const std::vector<unsigned> &op=expr_map[nr].op;
 
-      if(is_true(e_nr)) // !true == false
+  if(id==ID_if)
+  {
+    if(is_false(op[0])) // false ? x : y == y
+      implies_equal(op[2], nr);
+    else if(is_true(op[0])) // true ? x : y == x
+      implies_equal(op[1], nr);
+
+    if(is_equal(op[2], op[1])) // c ? x : x == x
+      implies_equal(op[2], nr);
+  }
+  else if(id==ID_or || id==ID_and)
+  {
+    // neutral and dominating elements
+    bool neutral=(id==ID_or)?false:true;
+    unsigned neutral_nr=neutral?true_nr:false_nr;
+    unsigned dominating_nr=neutral?false_nr:true_nr;
+
+    // x || true == true, x && false == false
+    unsigned non_neutral=0, last=0;
+    for(unsigned i=0; i<op.size(); i++)
+    {
+      if(is_equal(op[i], dominating_nr))
       {
-        implies_equal(false_nr, se.op[0], progress);
+        implies_equal(dominating_nr, nr);
+        return;
       }
-      else if(is_false(e_nr)) // !false == true
+      if(!is_equal(op[i], neutral_nr))
       {
-        implies_equal(true_nr, se.op[0], progress);
+        non_neutral++;
+        last=op[i];
       }
     }
 
-    for(solver_expr_listt::const_iterator
-        equal_it=equal_list.begin();
-        equal_it!=equal_list.end();
-        equal_it++)
-    {
-      unsigned e_nr=*equal_it;
-      const solver_exprt &se=expr_map[e_nr];
-      
-      unsigned op0=equalities.find(se.op[0]);
-      unsigned op1=equalities.find(se.op[1]);
-
-      // Is it equal?
-      if(is_equal(op0, op1))
-        implies_equal(true_nr, e_nr, progress);
-      
-      // Is there a disequality for this equality?
-      for(disequalitiest::const_iterator
-          d_it=disequalities.begin();
-          d_it!=disequalities.end();
-          d_it++)
-      {
-        const std::set<unsigned> &diseq_set=d_it->second;
-      
-        for(std::set<unsigned>::const_iterator
-            diseq_it=diseq_set.begin(); diseq_it!=diseq_set.end(); diseq_it++)
-        {
-          if(is_equal(d_it->first, op0) &&
-             is_equal(*diseq_it, op1))
-          {
-            implies_equal(false_nr, e_nr, progress);
-          }
-          else if(is_equal(d_it->first, op1) &&
-                  is_equal(*diseq_it, op0))
-          {
-            implies_equal(false_nr, e_nr, progress);
-          }
-        }
-      }
-    }
+    // x || false == x, x && true == x
+    if(non_neutral==0)
+      implies_equal(neutral_nr, nr);
+    else if(non_neutral==1)
+      implies_equal(last, nr);
 
-    for(uf_mapt::const_iterator
-        uf_map_it=uf_map.begin();
-        uf_map_it!=uf_map.end();
-        uf_map_it++)
+    // !(x || y) ===> !x, !y; a && b ===> a, b
+    if(is_equal(nr, neutral_nr))
     {
-      const solver_expr_listt &uf_list=uf_map_it->second;
-    
-      // boo, quadratic!
-      for(solver_expr_listt::const_iterator
-          uf_it1=uf_list.begin();
-          uf_it1!=uf_list.end();
-          uf_it1++)
-      {
-        solver_expr_listt::const_iterator next=uf_it1;
-        next++;
-      
-        for(solver_expr_listt::const_iterator
-            uf_it2=next;
-            uf_it2!=uf_list.end();
-            uf_it2++)
-        {
-          unsigned e_nr1=*uf_it1, e_nr2=*uf_it2;
-          const solver_exprt &se1=expr_map[e_nr1], 
-                             &se2=expr_map[e_nr2];
-
-          // same number of arguments?        
-          if(se1.op.size()!=se2.op.size()) continue;
-          
-          // already equal?
-          if(is_equal(e_nr1, e_nr2)) continue;
-          
-          bool all_equal=true;
-          
-          for(unsigned i=0; i<se1.op.size(); i++)
-          {
-            if(!is_equal(se1.op[i], se2.op[i]))
-            {
-              #ifdef DEBUG
-              std::cout << "UF check " 
-                        << e_nr1 << " vs " << e_nr2
-                        << ": op " << i << " not equal\n";
-              #endif
-              all_equal=false;
-              break;
-            }
-          }
-          
-          if(all_equal)
-          {
-            #ifdef DEBUG
-            std::cout << "UF check: " 
-                      << e_nr1 << " = " << e_nr2 << "\n";
-            #endif
-            implies_equal(e_nr1, e_nr2, progress);
-          }
-        }
-      }
+      for(unsigned i=0; i<op.size(); i++)
+        implies_equal(op[i], neutral_nr);
     }
   }
-  while(progress);
-  
-  // check if we are consistent
-  
-  if(is_equal(true_nr, false_nr))
-    return D_UNSATISFIABLE;
+  else if(id==ID_not)
+  {
+    if(is_true(op[0])) // !true == false
+      implies_equal(false_nr, nr);
+    else if(is_false(op[0])) // !false == true
+      implies_equal(true_nr, nr);
+
+    if(is_true(nr)) // !x == true ===> x == false
+      implies_equal(false_nr, op[0]);
+    else if(is_false(nr)) // !x == false ===> x == true
+      implies_equal(true_nr, op[0]);
+  }
+  else if(id==ID_equal)
+  {
+    // Is it equal?
+    if(is_equal(op[0], op[1]))
+      implies_equal(true_nr, nr);
+    // Is there a disequality for this equality?
+    else if(is_disequal(op[0], op[1]))
+      implies_equal(false_nr, nr);
+  }
+}
 
-  for(disequalitiest::const_iterator
-      d_it=disequalities.begin();
-      d_it!=disequalities.end();
-      d_it++)
+/*******************************************************************\
+
+Function: solvert::propagate
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void solvert::propagate()
+{
+  while(!inconsistent)
   {
-    const std::set<unsigned> &diseq_set=d_it->second;
-  
-    for(std::set<unsigned>::const_iterator
-        diseq_it=diseq_set.begin(); diseq_it!=diseq_set.end(); diseq_it++)
+    if(!pending.empty())
     {
-      if(is_equal(d_it->first, *diseq_it))
-        return D_UNSATISFIABLE;
+      std::pair<unsigned, unsigned> p=pending.back();
+      pending.pop_back();
+      merge(p.first, p.second);
     }
+    else if(!todo.empty())
+    {
+      unsigned nr=todo.back();
+      todo.pop_back();
+      check_node(nr);
+    }
+    else
+      break;
   }
-  
-  for(unsigned i=0; i<expr_numbering.size(); i++)
+
+  if(inconsistent)
   {
-    if(integer_intervals[i].is_bottom()) return D_UNSATISFIABLE;
-    if(ieee_float_intervals[i].is_bottom()) return D_UNSATISFIABLE;
+    pending.clear();
+    todo.clear();
   }
+}
+
+/*******************************************************************\
+
+Function: solvert::dec_solve
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+decision_proceduret::resultt solvert::dec_solve()
+{
+  propagate();
+
+  if(inconsistent)
+    return D_UNSATISFIABLE;
 
   return D_SATISFIABLE;
 }
 
 /*******************************************************************\
 
+Function: solvert::push
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void solvert::push()
+{
+  // we don't backtrack the worklists
+  propagate();
+
+  contextt context;
+  context.trail_size=trail.size();
+  context.number_of_expressions=expr_numbering.size();
+  contexts.push_back(context);
+}
+
+/*******************************************************************\
+
+Function: solvert::pop
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void solvert::pop()
+{
+  assert(!contexts.empty());
+  const contextt context=contexts.back();
+  contexts.pop_back();
+
+  pending.clear();
+  todo.clear();
+
+  while(trail.size()>context.trail_size)
+  {
+    const trail_entryt entry=trail.back();
+    trail.pop_back();
+
+    switch(entry.kind)
+    {
+    case trail_entryt::MERGE:
+      {
+        solver_exprt &s_se=expr_map[entry.a];
+        solver_exprt &r_se=expr_map[s_se.parent];
+        r_se.members.resize(r_se.members.size()-s_se.members.size());
+        r_se.use_list.resize(entry.b);
+        s_se.parent=entry.a;
+      }
+      break;
+    case trail_entryt::USE:
+      expr_map[entry.a].use_list.pop_back();
+      break;
+    case trail_entryt::DISEQUAL:
+      expr_map[entry.a].disequal.erase(entry.b);
+      break;
+    case trail_entryt::SIGNATURE:
+      signature_table.erase(signature_trail.back());
+      signature_trail.pop_back();
+      break;
+    case trail_entryt::PROCESSED:
+      expr_map[entry.a].predicate_processed=false;
+      break;
+    case trail_entryt::INTERVAL:
+      integer_intervals[entry.a]=interval_trail.back().first;
+      ieee_float_intervals[entry.a]=interval_trail.back().second;
+      interval_trail.pop_back();
+      break;
+    case trail_entryt::INCONSISTENT:
+      inconsistent=false;
+      break;
+    }
+  }
+
+  // the expressions added since then stay,
+  // but their axioms and congruences need to be restored
+  for(unsigned nr=context.number_of_expressions;
+      nr<expr_numbering.size(); nr++)
+    register_node(nr);
+
+  propagate();
+}
+
+/*******************************************************************\
+
 Function: solvert::set_to
 
   Inputs:
@@ -712,10 +963,9 @@ Function: solvert::bound
 
 void solvert::bound(
   const constant_exprt &bound,
-  const exprt &what,
+  unsigned what,
   weak_strictt weak_strict,
-  lower_uppert lower_upper,
-  bool &progress)
+  lower_uppert lower_upper)
 {
   const typet &type=bound.type();
   
@@ -739,10 +989,7 @@ void solvert::bound(
     else
       new_interval.set_upper(int_val);
 
-    integer_intervalt &interval=integer_intervals[add(what)];
-    
-    if(interval.meet(new_interval))
-      progress=true;
+    meet_intervals(find(what), new_interval, ieee_float_intervalt());
   }
   else if(type.id()==ID_floatbv)
   {
@@ -756,10 +1003,7 @@ void solvert::bound(
     else
       new_interval.set_upper(float_val);
 
-    ieee_float_intervalt &interval=ieee_float_intervals[add(what)];
-
-    if(interval.meet(new_interval))
-      progress=true;
+    meet_intervals(find(what), integer_intervalt(), new_interval);
   }
 }
 
@@ -831,11 +1075,11 @@ exprt solvert::get(const exprt &expr) const
   if(!expr_numbering.get_number(tmp, nr))
   {
     // Equal to some constant?
-    for(unsigned i=0; i<equalities.size(); i++)
-      if(i!=nr &&
-         is_equal(i, nr) &&
-         is_a_constant(expr_numbering[i]))
-        return expr_numbering[i];
+    const std::vector<unsigned> &members=expr_map[find(nr)].members;
+    for(unsigned i=0; i<members.size(); i++)
+      if(members[i]!=nr &&
+         is_a_constant(expr_numbering[members[i]]))
+        return expr_numbering[members[i]];
   }
 
   return nil_exprt();
@@ -857,25 +1101,17 @@ void solvert::print_assignment(std::ostream &out) const
 {
   // equalities
   
-  std::map<unsigned, std::set<unsigned> > equality_map;
-  
   for(unsigned i=0; i<expr_numbering.size(); i++)
-    equality_map[equalities.find(i)].insert(i);
-  
-  for(std::map<unsigned, std::set<unsigned> >::const_iterator
-      e_it=equality_map.begin();
-      e_it!=equality_map.end();
-      e_it++)
   {
-    const std::set<unsigned> &eq_set=e_it->second;
+    if(find(i)!=i) continue;
+    const std::vector<unsigned> &members=expr_map[i].members;
   
-    if(eq_set.size()>=2)
+    if(members.size()>=2)
     {
-      for(std::set<unsigned>::const_iterator
-          eq_it=eq_set.begin(); eq_it!=eq_set.end(); eq_it++)
+      for(unsigned j=0; j<members.size(); j++)
       {
         out << "Equal: "
-            << from_expr(ns, "", expr_numbering[*eq_it]) << "\n";
+            << from_expr(ns, "", expr_numbering[members[j]]) << "\n";
       }
 
       out << "\n";
@@ -884,18 +1120,19 @@ void solvert::print_assignment(std::ostream &out) const
   
   // disequalities
   
-  for(disequalitiest::const_iterator
-      d_it=disequalities.begin();
-      d_it!=disequalities.end();
-      d_it++)
+  for(unsigned i=0; i<expr_numbering.size(); i++)
   {
-    const std::set<unsigned> &diseq_set=d_it->second;
+    if(find(i)!=i) continue;
+    const std::set<unsigned> &diseq_set=expr_map[i].disequal;
   
     for(std::set<unsigned>::const_iterator
         diseq_it=diseq_set.begin(); diseq_it!=diseq_set.end(); diseq_it++)
     {
+      // print each pair of roots once
+      if(*diseq_it<i || find(*diseq_it)!=*diseq_it) continue;
+
       out << "Disequal: "
-          << from_expr(ns, "", expr_numbering[d_it->first])
+          << from_expr(ns, "", expr_numbering[i])
           << " != "
           << from_expr(ns, "", expr_numbering[*diseq_it])
           << "\n";
@@ -904,11 +1141,10 @@ void solvert::print_assignment(std::ostream &out) const
   
   // intervals
 
-  for(integer_intervalst::const_iterator
-      i_it=integer_intervals.begin();
-      i_it!=integer_intervals.end(); i_it++)
+  for(unsigned i=0; i<expr_numbering.size(); i++)
   {
-    const integer_intervalt &interval=*i_it;
+    if(find(i)!=i) continue;
+    const integer_intervalt &interval=integer_intervals[i];
     
     if(interval.is_top()) continue;
     
@@ -917,7 +1153,7 @@ void solvert::print_assignment(std::ostream &out) const
     if(interval.lower_set)
       out << interval.lower << " <= ";
 
-    out << from_expr(ns, "", expr_numbering[i_it-integer_intervals.begin()]);
+    out << from_expr(ns, "", expr_numbering[i]);
     
     if(interval.upper_set)
       out << " <= " << interval.upper;
@@ -927,11 +1163,10 @@ void solvert::print_assignment(std::ostream &out) const
     out << "\n";
   }
 
-  for(ieee_float_intervalst::const_iterator
-      i_it=ieee_float_intervals.begin();
-      i_it!=ieee_float_intervals.end(); i_it++)
+  for(unsigned i=0; i<expr_numbering.size(); i++)
   {
-    const ieee_float_intervalt &interval=*i_it;
+    if(find(i)!=i) continue;
+    const ieee_float_intervalt &interval=ieee_float_intervals[i];
     
     if(interval.is_top()) continue;
     
@@ -940,7 +1175,7 @@ void solvert::print_assignment(std::ostream &out) const
     if(interval.lower_set)
       out << interval.lower << " <= ";
 
-    out << from_expr(ns, "", expr_numbering[i_it-ieee_float_intervals.begin()]);
+    out << from_expr(ns, "", expr_numbering[i]);
     
     if(interval.upper_set)
       out << " <= " << interval.upper;
@@ -949,6 +1184,4 @@ void solvert::print_assignment(std::ostream &out) const
     
     out << "\n";
   }
-
 }
-  
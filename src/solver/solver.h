@@ -10,10 +10,13 @@ Author: Daniel Kroening, kroening@kroening.com
 #define CPROVER_DELTACHECK_SOLVER_H
 
 #include <set>
+#include <vector>
 
 #include <util/decision_procedure.h>
-#include <util/union_find.h>
 #include <util/expanding_vector.h>
+#include <util/numbering.h>
+#include <util/hash_cont.h>
+#include <util/threeval.h>
 
 #include <analyses/intervals.h>
 
@@ -47,6 +50,12 @@ public:
     add(expr);
   }
 
+  // Backtracking: everything that is asserted after push()
+  // is retracted by the matching pop().
+  // The expressions themselves are kept.
+  void push();
+  void pop();
+
 protected:
   // Used to determine whether an expression is suitable
   // as value for a model.
@@ -63,64 +72,41 @@ protected:
   // make 'a' and 'b' equal
   inline void set_equal(unsigned a, unsigned b)
   {
-    equalities.make_union(a, b);
+    merge(a, b);
   }
 
-  // make 'a' and 'b' equal, and track if
-  // this wasn't the case before
-  inline void implies_equal(unsigned a, unsigned b, bool &progress)
+  // make 'a' and 'b' equal as a consequence
+  inline void implies_equal(unsigned a, unsigned b)
   {
-    if(is_equal(a, b)) return; // no progres
-    equalities.make_union(a, b);
-    progress=true; // progress!
+    if(is_equal(a, b)) return;
+    merge(a, b);
   }
   
-  // add a bound, and track if this is a new bound
+  inline void set_disequal(unsigned a, unsigned b)
+  {
+    add_disequality(find(a), find(b));
+  }
+
+  inline void implies_disequal(unsigned a, unsigned b)
+  {
+    add_disequality(find(a), find(b));
+  }
+
+  // add a bound to the class of 'what'
   enum weak_strictt { WEAK, STRICT };
   enum lower_uppert { LOWER, UPPER };
   
   void bound(const constant_exprt &bound,
-             const exprt &what,
+             unsigned what,
              weak_strictt weak_strict,
-             lower_uppert lower_upper,
-             bool &progress);
+             lower_uppert lower_upper);
   
   // a numbering for expressions
   numbering<exprt> expr_numbering;
 
-  // equality logic
-  unsigned_union_find equalities;
-  
-  inline bool is_equal(unsigned a, unsigned b) const
-  {
-    return equalities.find(a)==equalities.find(b);
-  }
-  
-  // Disequalities; the smaller index is the key.
-  // This should really use roots from the equalities.
-  typedef std::map<unsigned, std::set<unsigned> > disequalitiest;
-  disequalitiest disequalities;
-  
-  inline bool is_disequal(unsigned a, unsigned b) const
-  {
-    if(a>b) std::swap(a, b);
-    disequalitiest::const_iterator it=disequalities.find(a);
-    if(it==disequalities.end()) return false;
-    return it->second.find(b)!=it->second.end();
-  }
-
-  void implies_disequal(unsigned a, unsigned b, bool &progress)
-  {
-    if(a>b) std::swap(a, b);
-    if((disequalities[a].insert(b)).second)
-      progress=true;
-  }
-
-  void set_disequal(unsigned a, unsigned b)
-  {
-    if(a>b) std::swap(a, b);
-    disequalities[a].insert(b);
-  }
+  // a numbering for the function symbols of expressions,
+  // i.e., the expressions without their operands
+  numbering<exprt> function_numbering;
 
   // further data per expression
   struct solver_exprt
@@ -128,30 +114,97 @@ protected:
     // the numbers of the operands
     std::vector<unsigned> op;
     
-    // the numbers of the expressions that contain this one
-    std::vector<unsigned> operand_of;
+    // the number of the function symbol (for congruence)
+    unsigned function_nr;
     
+    // union-find parent; no path compression
+    // to allow for backtracking
+    unsigned parent;
+
+    // the following are valid for roots only:
+
+    // the members of the equivalence class
+    std::vector<unsigned> members;
+
+    // the expressions that contain a member as operand
+    std::vector<unsigned> use_list;
+
+    // the roots of the classes this one is disequal to
+    std::set<unsigned> disequal;
+
     bool predicate_processed;
     
-    solver_exprt():predicate_processed(false)
+    solver_exprt():function_nr(0), parent(0), predicate_processed(false)
     {
     }
   };
   
-  typedef expanding_vector<solver_exprt> expr_mapt;
+  typedef std::vector<solver_exprt> expr_mapt;
   expr_mapt expr_map;
 
-  // lists of expressions with particular IDs  
-  typedef std::vector<unsigned> solver_expr_listt;
-  solver_expr_listt if_list, or_list, and_list, not_list, equal_list;
+  // equality logic
+  inline unsigned find(unsigned a) const
+  {
+    while(expr_map[a].parent!=a) a=expr_map[a].parent;
+    return a;
+  }
+  
+  inline bool is_equal(unsigned a, unsigned b) const
+  {
+    return find(a)==find(b);
+  }
+  
+  bool is_disequal(unsigned a, unsigned b) const;
+
+  void merge(unsigned a, unsigned b);
+  void add_disequality(unsigned root1, unsigned root2);
+
+  // is the class of 'root' true, false or unknown?
+  tvt class_value(unsigned root) const;
+
+  // signature table for congruence closure:
+  // function symbol number, followed by the roots of the operands
+  typedef std::vector<unsigned> signaturet;
+  
+  struct signature_hasht
+  {
+    size_t operator()(const signaturet &signature) const
+    {
+      size_t h=0;
+      for(unsigned i=0; i<signature.size(); i++)
+        h=(h<<5)+h+signature[i];
+      return h;
+    }
+  };
+
+  typedef hash_map_cont<signaturet, unsigned, signature_hasht> signature_tablet;
+  signature_tablet signature_table;
 
-  // uninterpreted functions (and predicates), mapping
-  // expression id -> to the list of expressions of this kind  
-  typedef std::map<irep_idt, solver_expr_listt> uf_mapt;
-  uf_mapt uf_map;
+  void get_signature(unsigned nr, signaturet &signature) const;
+
+  // looks up the signature of an expression and
+  // queues a congruence if there is one
+  void update_signature(unsigned nr);
+
+  // congruences waiting to be merged
+  std::vector<std::pair<unsigned, unsigned> > pending;
+  
+  // expressions whose rules need to be re-evaluated
+  std::vector<unsigned> todo;
+  
+  // evaluates the rules of the given expression
+  void check_node(unsigned nr);
+  void process_predicate(unsigned nr, bool value);
+
+  // propagates until the worklists are empty
+  void propagate();
+  
+  // the conjunction of the constraints is unsatisfiable
+  bool inconsistent;
+  void set_inconsistent();
 
   // builds above solver_exprt for given expression  
-  solver_exprt build_solver_expr(unsigned nr);
+  void init_node(unsigned nr);
 
   // called to recurse over the operands of a new expression
   void add_operands(unsigned nr);
@@ -159,6 +212,9 @@ protected:
   // called after new expresion with given number has been added
   void new_expression(unsigned nr);
 
+  // sets up use lists, signatures and axioms of an expression
+  void register_node(unsigned nr);
+
   // handy numbers of well-known constants
   unsigned false_nr, true_nr;
   
@@ -172,11 +228,44 @@ protected:
     return is_equal(a, false_nr);
   }
 
-  // interval domain
-  typedef expanding_vector<integer_intervalt> integer_intervalst;
-  typedef expanding_vector<ieee_float_intervalt> ieee_float_intervalst;
+  // interval domain, for roots only
+  typedef std::vector<integer_intervalt> integer_intervalst;
+  typedef std::vector<ieee_float_intervalt> ieee_float_intervalst;
   ieee_float_intervalst ieee_float_intervals;
   integer_intervalst integer_intervals;
+
+  // meet the intervals of 'root' with the given ones
+  void meet_intervals(unsigned root,
+                      const integer_intervalt &integer_interval,
+                      const ieee_float_intervalt &ieee_float_interval);
+
+  // trail for backtracking
+  struct trail_entryt
+  {
+    typedef enum { MERGE, USE, DISEQUAL, SIGNATURE, 
+                   PROCESSED, INTERVAL, INCONSISTENT } kindt;
+    kindt kind;
+    unsigned a, b;
+
+    trail_entryt(kindt _kind, unsigned _a=0, unsigned _b=0):
+      kind(_kind), a(_a), b(_b)
+    {
+    }
+  };
+
+  typedef std::vector<trail_entryt> trailt;
+  trailt trail;
+  std::vector<signaturet> signature_trail;
+  std::vector<std::pair<integer_intervalt, ieee_float_intervalt> > 
+    interval_trail;
+
+  struct contextt
+  {
+    unsigned trail_size;
+    unsigned number_of_expressions;
+  };
+
+  std::vector<contextt> contexts;
 };
 
 #endif
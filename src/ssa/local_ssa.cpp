@@ -397,9 +397,17 @@ Function: local_SSAt::dereference
 
 exprt local_SSAt::dereference(const exprt &src, locationt loc) const
 {
+  std::pair<unsigned, exprt> key(loc->location_number, src);
+  dereference_cachet::const_iterator c_it=dereference_cache.find(key);
+  if(c_it!=dereference_cache.end())
+    return c_it->second;
+
   const ssa_value_domaint &ssa_value_domain=ssa_value_ai[loc];
   const std::string nondet_prefix="deref#"+i2string(loc->location_number);
-  return ::dereference(src, ssa_value_domain, nondet_prefix, ns);
+  exprt result=
+    ::dereference(src, ssa_value_domain, nondet_prefix, ns, &alias_cache);
+  dereference_cache[key]=result;
+  return result;
 }
 
 /*******************************************************************\
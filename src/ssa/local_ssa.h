@@ -17,6 +17,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include "ssa_domain.h"
 #include "guard_map.h"
 #include "ssa_object.h"
+#include "ssa_dereference.h"
 
 #define TEMPLATE_PREFIX "__CPROVER_template"
 #define TEMPLATE_DECL TEMPLATE_PREFIX
@@ -164,6 +165,11 @@ public:
   
   exprt dereference(const exprt &expr, locationt loc) const;
 
+  // dereferencing is memoized per location
+  typedef std::map<std::pair<unsigned, exprt>, exprt> dereference_cachet;
+  mutable dereference_cachet dereference_cache;
+  mutable ssa_alias_cachet alias_cache;
+
   ssa_objectst ssa_objects;
   typedef ssa_objectst::objectst objectst;
   ssa_value_ait ssa_value_ai;
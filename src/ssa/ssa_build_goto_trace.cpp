@@ -13,6 +13,34 @@ Author: Daniel Kroening, Peter Schrammel
 
 /*******************************************************************\
 
+Function: ssa_build_goto_tracet::get
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: value of the SSA expression in the model
+
+\*******************************************************************/
+
+exprt ssa_build_goto_tracet::get(const exprt &expr)
+{
+  if(model!=NULL)
+  {
+    ssa_trace_modelt::const_iterator it=model->find(expr);
+    if(it==model->end())
+      return nil_exprt();
+    return it->second;
+  }
+
+  exprt value=prop_conv->get(expr);
+  if(snapshot!=NULL)
+    (*snapshot)[expr]=value;
+  return value;
+}
+
+/*******************************************************************\
+
 Function: ssa_build_goto_tracet::finalize_lhs
 
   Inputs:
@@ -32,14 +60,14 @@ exprt ssa_build_goto_tracet::finalize_lhs(const exprt &src)
     index_exprt tmp=to_index_expr(src);
     tmp.array()=finalize_lhs(tmp.array());
     exprt index = unwindable_local_SSA.read_rhs(tmp.index(),current_pc);
-    tmp.index()=simplify_expr(prop_conv.get(index), unwindable_local_SSA.ns);
+    tmp.index()=simplify_expr(get(index), unwindable_local_SSA.ns);
     return tmp;
   }
   else if(src.id()==ID_dereference)
   {
     address_of_exprt tmp1(src);
     exprt tmp2 = unwindable_local_SSA.read_rhs(tmp1,current_pc);
-    exprt tmp3=prop_conv.get(tmp2);
+    exprt tmp3=get(tmp2);
     exprt tmp4=tmp3;
     if(tmp4.id()==ID_constant && tmp4.type().id()==ID_pointer &&
        tmp4.operands().size()==1 && tmp4.op0().id()==ID_address_of)
@@ -70,10 +98,36 @@ Function: ssa_build_goto_tracet::record_step
 \*******************************************************************/
 
 bool ssa_build_goto_tracet::record_step(
-  goto_tracet &goto_trace,
-  unsigned &step_nr)
+  unsigned &step_nr,
+  bool &assertion_failed)
 {
   bool taken = true;
+  assertion_failed = false;
+  if(goto_trace==NULL)
+  {
+    // only take the snapshot: query the values that are
+    //  needed for the trace, but do not build the steps
+    if(current_pc->is_goto())
+    {
+      exprt cond_read = unwindable_local_SSA.read_rhs(current_pc->guard,current_pc);
+      taken = simplify_expr(get(cond_read), unwindable_local_SSA.ns).is_true();
+    }
+    else if(current_pc->is_assert())
+    {
+      exprt cond_read = unwindable_local_SSA.read_rhs(current_pc->guard,current_pc);
+      assertion_failed = 
+        simplify_expr(get(cond_read), unwindable_local_SSA.ns).is_false();
+    }
+    else if(current_pc->is_assign())
+    {
+      const code_assignt &code_assign=
+        to_code_assign(current_pc->code);
+      get(unwindable_local_SSA.read_rhs(code_assign.rhs(),current_pc));
+      finalize_lhs(code_assign.lhs());
+    }
+    return taken;
+  }
+
   goto_trace_stept step;
   step.pc=current_pc;
   step.step_nr=step_nr;
@@ -91,14 +145,14 @@ bool ssa_build_goto_tracet::record_step(
   case THROW:
   case CATCH:
     step.type=goto_trace_stept::LOCATION;
-    goto_trace.add_step(step);
+    goto_trace->add_step(step);
     step_nr++;
     break;
 
   case ASSUME:
     step.type=goto_trace_stept::ASSUME;
     step.cond_value=true;
-    goto_trace.add_step(step);
+    goto_trace->add_step(step);
     step_nr++;
     break;
   
@@ -106,7 +160,7 @@ bool ssa_build_goto_tracet::record_step(
     {
       exprt cond=current_pc->guard;
       exprt cond_read = unwindable_local_SSA.read_rhs(cond,current_pc);
-      exprt cond_value=simplify_expr(prop_conv.get(cond_read), unwindable_local_SSA.ns);
+      exprt cond_value=simplify_expr(get(cond_read), unwindable_local_SSA.ns);
       step.type=goto_trace_stept::GOTO;
       step.cond_expr = cond_value; //cond
       step.cond_value = cond_value.is_true();
@@ -117,7 +171,7 @@ bool ssa_build_goto_tracet::record_step(
 #endif
       if(step.cond_value)
       {
-        goto_trace.add_step(step);
+        goto_trace->add_step(step);
         step_nr++;
       }
       else
@@ -130,15 +184,16 @@ bool ssa_build_goto_tracet::record_step(
       // failed or not?
       exprt cond=current_pc->guard;
       exprt cond_read=unwindable_local_SSA.read_rhs(cond,current_pc);
-      exprt cond_value=simplify_expr(prop_conv.get(cond_read), unwindable_local_SSA.ns);
+      exprt cond_value=simplify_expr(get(cond_read), unwindable_local_SSA.ns);
       if(cond_value.is_false())
       {
         step.type=goto_trace_stept::ASSERT;
         step.comment=id2string(current_pc->source_location.get_comment());
         step.cond_expr=cond;
         step.cond_value=false;
-        goto_trace.add_step(step);
+        goto_trace->add_step(step);
         step_nr++;
+        assertion_failed = true;
       }
     }
     break;
@@ -154,7 +209,7 @@ bool ssa_build_goto_tracet::record_step(
       const code_assignt &code_assign=
         to_code_assign(current_pc->code);
       exprt rhs_ssa=unwindable_local_SSA.read_rhs(code_assign.rhs(),current_pc);
-      exprt rhs_value=prop_conv.get(rhs_ssa);
+      exprt rhs_value=get(rhs_ssa);
       exprt rhs_simplified=simplify_expr(rhs_value, unwindable_local_SSA.ns);
       exprt lhs_ssa=finalize_lhs(code_assign.lhs());
       exprt lhs_simplified=simplify_expr(lhs_ssa, unwindable_local_SSA.ns);
@@ -182,14 +237,14 @@ bool ssa_build_goto_tracet::record_step(
 		<< " == " << from_expr(unwindable_local_SSA.ns, 
 				       "", step.full_lhs_value) << std::endl;
 #endif
-      goto_trace.add_step(step);
+      goto_trace->add_step(step);
       step_nr++;
     }
     break;
 
   case OTHER:
     step.type=goto_trace_stept::LOCATION;
-    goto_trace.add_step(step);
+    goto_trace->add_step(step);
     step_nr++;
     break;
     
@@ -202,7 +257,7 @@ bool ssa_build_goto_tracet::record_step(
 
 /*******************************************************************\
 
-Function: ssa_build_goto_tracet::operator()
+Function: ssa_build_goto_tracet::run
 
   Inputs:
 
@@ -212,8 +267,7 @@ Function: ssa_build_goto_tracet::operator()
 
 \*******************************************************************/
 
-void ssa_build_goto_tracet::operator()(
-  goto_tracet &goto_trace)
+void ssa_build_goto_tracet::run()
 {
   if(unwindable_local_SSA.goto_function.body.instructions.empty())
     return;
@@ -250,10 +304,10 @@ void ssa_build_goto_tracet::operator()(
 	      << unwindable_local_SSA.odometer_to_string(unwindable_local_SSA.current_unwindings,100) << std::endl;
 #endif
 
-    bool taken = record_step(goto_trace, step_nr);
+    bool assertion_failed;
+    bool taken = record_step(step_nr, assertion_failed);
     
-    if(!goto_trace.steps.empty() &&
-       goto_trace.steps.back().is_assert())
+    if(assertion_failed)
       break; // done
     
     // get successor
@@ -269,3 +323,44 @@ void ssa_build_goto_tracet::operator()(
       current_pc++;
   }
 }
+
+/*******************************************************************\
+
+Function: ssa_build_goto_tracet::operator()
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void ssa_build_goto_tracet::operator()(
+  goto_tracet &_goto_trace)
+{
+  goto_trace=&_goto_trace;
+  run();
+  goto_trace=NULL;
+}
+
+/*******************************************************************\
+
+Function: ssa_build_goto_tracet::take_snapshot
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void ssa_build_goto_tracet::take_snapshot(
+  ssa_trace_modelt &_snapshot)
+{
+  assert(prop_conv!=NULL);
+  snapshot=&_snapshot;
+  run();
+  snapshot=NULL;
+}
@@ -9,12 +9,19 @@ Author: Daniel Kroening, Peter Schrammel
 #ifndef CPROVER_SSA_BUILD_GOTO_TRACE_H
 #define CPROVER_SSA_BUILD_GOTO_TRACE_H
 
+#include <map>
+
 #include <goto-programs/goto_trace.h>
 #include <solvers/prop/prop_conv.h>
 
 #include "local_ssa.h"
 #include "unwindable_local_ssa.h"
 
+// The values of the SSA expressions queried when building a trace.
+// Much smaller than the trace itself, it can be taken while the
+// solver model is available and turned into a trace later.
+typedef std::map<exprt, exprt> ssa_trace_modelt;
+
 class ssa_build_goto_tracet {
 public:
   ssa_build_goto_tracet(
@@ -22,21 +29,44 @@ public:
     const prop_convt &_prop_conv) 
   : 
   unwindable_local_SSA(_unwindable_local_SSA),  
-  prop_conv(_prop_conv)
+  prop_conv(&_prop_conv),
+  model(NULL),
+  snapshot(NULL),
+  goto_trace(NULL)
+  {}
+
+  // replays a snapshot taken by take_snapshot
+  ssa_build_goto_tracet(
+    unwindable_local_SSAt &_unwindable_local_SSA,
+    const ssa_trace_modelt &_model) 
+  : 
+  unwindable_local_SSA(_unwindable_local_SSA),  
+  prop_conv(NULL),
+  model(&_model),
+  snapshot(NULL),
+  goto_trace(NULL)
   {}
 
   void operator()(goto_tracet &);
 
+  // records the values needed for the trace without building it
+  void take_snapshot(ssa_trace_modelt &);
+
 protected:
   unwindable_local_SSAt &unwindable_local_SSA;
-  const prop_convt &prop_conv;
+  const prop_convt *prop_conv;
+  const ssa_trace_modelt *model;
+  ssa_trace_modelt *snapshot;
+  goto_tracet *goto_trace; // NULL if only taking a snapshot
   goto_programt::const_targett current_pc;
 
+  exprt get(const exprt &expr);
   exprt finalize_lhs(const exprt &src);
 
+  void run();
   bool record_step(
-    goto_tracet &goto_trace,
-    unsigned &step_nr);
+    unsigned &step_nr,
+    bool &assertion_failed);
 };
 
 #endif
@@ -293,6 +293,39 @@ exprt ssa_alias_value(
 
 /*******************************************************************\
 
+Function: ssa_alias_cachet::operator()
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: the guard is simplified once such that impossible
+          aliases can be pruned
+
+\*******************************************************************/
+
+const ssa_alias_cachet::aliast &ssa_alias_cachet::operator()(
+  const exprt &src,
+  const exprt &object,
+  const namespacet &ns)
+{
+  std::pair<alias_mapt::iterator, bool> entry=
+    alias_map.insert(
+      std::make_pair(std::make_pair(src, object), aliast()));
+  aliast &alias=entry.first->second;
+
+  if(entry.second)
+  {
+    alias.guard=simplify_expr(ssa_alias_guard(src, object, ns), ns);
+    if(!alias.guard.is_false())
+      alias.value=ssa_alias_value(src, object, ns);
+  }
+
+  return alias;
+}
+
+/*******************************************************************\
+
 Function: dereference_rec
 
   Inputs:
@@ -307,12 +340,12 @@ exprt dereference_rec(
  const exprt &src,
  const ssa_value_domaint &ssa_value_domain, 
  const std::string &nondet_prefix,
- const namespacet &ns)
+ const namespacet &ns,
+ ssa_alias_cachet *alias_cache)
 {
   if(src.id()==ID_dereference)
   {
     const exprt &pointer=to_dereference_expr(src).pointer();
-    exprt pointer_deref=dereference(pointer, ssa_value_domain, nondet_prefix, ns);
 
     // We use the identifier produced by
     // local_SSAt::replace_side_effects_rec
@@ -327,9 +360,20 @@ exprt dereference_rec(
         it!=values.value_set.end();
         it++)
     {
-      exprt guard=ssa_alias_guard(src, it->get_expr(), ns);
-      exprt value=ssa_alias_value(src, it->get_expr(), ns);
-      result=if_exprt(guard, value, result);
+      if(alias_cache!=NULL)
+      {
+        const ssa_alias_cachet::aliast &alias=
+          (*alias_cache)(src, it->get_expr(), ns);
+        if(alias.guard.is_false())
+          continue;
+        result=if_exprt(alias.guard, alias.value, result);
+      }
+      else
+      {
+        exprt guard=ssa_alias_guard(src, it->get_expr(), ns);
+        exprt value=ssa_alias_value(src, it->get_expr(), ns);
+        result=if_exprt(guard, value, result);
+      }
     }
 
     return result;
@@ -337,7 +381,7 @@ exprt dereference_rec(
   else if(src.id()==ID_member)
   {
     member_exprt tmp=to_member_expr(src);
-    tmp.struct_op()=dereference_rec(tmp.struct_op(), ssa_value_domain, nondet_prefix, ns);
+    tmp.struct_op()=dereference_rec(tmp.struct_op(), ssa_value_domain, nondet_prefix, ns, alias_cache);
     
     #ifdef DEBUG
     std::cout << "dereference_rec tmp: " << from_expr(ns, "", tmp) << '\n';
@@ -351,7 +395,7 @@ exprt dereference_rec(
   else if(src.id()==ID_address_of)
   {
     address_of_exprt tmp=to_address_of_expr(src);
-    tmp.object()=dereference_rec(tmp.object(), ssa_value_domain, nondet_prefix, ns);
+    tmp.object()=dereference_rec(tmp.object(), ssa_value_domain, nondet_prefix, ns, alias_cache);
 
     if(tmp.object().is_nil())
       return nil_exprt();
@@ -362,7 +406,7 @@ exprt dereference_rec(
   {
     exprt tmp=src;
     Forall_operands(it, tmp)
-      *it=dereference_rec(*it, ssa_value_domain, nondet_prefix, ns);
+      *it=dereference_rec(*it, ssa_value_domain, nondet_prefix, ns, alias_cache);
     return tmp;
   }
 }
@@ -383,13 +427,14 @@ exprt dereference(
  const exprt &src,
  const ssa_value_domaint &ssa_value_domain, 
  const std::string &nondet_prefix,
- const namespacet &ns)
+ const namespacet &ns,
+ ssa_alias_cachet *alias_cache)
 {
   #ifdef DEBUG
   std::cout << "dereference src: " << from_expr(ns, "", src) << '\n';
   #endif
 
-  exprt tmp1=dereference_rec(src, ssa_value_domain, nondet_prefix, ns);
+  exprt tmp1=dereference_rec(src, ssa_value_domain, nondet_prefix, ns, alias_cache);
 
   #ifdef DEBUG
   std::cout << "dereference tmp1: " << from_expr(ns, "", tmp1) << '\n';
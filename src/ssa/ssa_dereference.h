@@ -9,6 +9,8 @@ Author: Daniel Kroening, kroening@kroening.com
 #ifndef CPROVER_SSA_ALIASING_H
 #define CPROVER_SSA_ALIASING_H
 
+#include <map>
+
 #include <util/std_expr.h>
 #include <util/namespace.h>
 
@@ -18,10 +20,32 @@ Author: Daniel Kroening, kroening@kroening.com
 //exprt ssa_alias_guard(const exprt &, const exprt &, const namespacet &);
 //exprt ssa_alias_value(const exprt &, const exprt &, const namespacet &);
 
+// The guard and value of a dereference for an object
+// that the pointer may point to do not depend on the location;
+// they are computed once per function.
+class ssa_alias_cachet
+{
+public:
+  struct aliast
+  {
+    exprt guard, value;
+  };
+
+  const aliast &operator()(
+    const exprt &src,
+    const exprt &object,
+    const namespacet &);
+
+protected:
+  typedef std::map<std::pair<exprt, exprt>, aliast> alias_mapt;
+  alias_mapt alias_map;
+};
+
 exprt dereference(
   const exprt &,
   const ssa_value_domaint &,
   const std::string &nondet_prefix,
-  const namespacet &);
+  const namespacet &,
+  ssa_alias_cachet *alias_cache=NULL);
 
 #endif
@@ -10,6 +10,7 @@ Author: Peter Schrammel
 #include <util/replace_expr.h>
 
 #include "ssa_inliner.h"
+#include "../domains/lazy_message.h"
 
 /*******************************************************************\
 
@@ -130,11 +131,31 @@ void ssa_inlinert::get_summaries(const local_SSAt &SSA,
       assert(f_it->function().id()==ID_symbol); //no function pointers
       irep_idt fname = to_symbol_expr(f_it->function()).get_identifier();
 
-      if(summary_db.exists(fname))
+      const summaryt *summary = summary_db.find(fname);
+      if(summary==NULL)
+        continue;
+
+      call_sitet call_site(&(*n_it),
+        std::make_pair(f_it-n_it->function_calls.begin(),forward));
+      unsigned version = summary_db.get_version(fname);
+      call_site_cachet::iterator c_it = call_site_cache.find(call_site);
+      if(c_it==call_site_cache.end() || 
+         c_it->second.version!=version ||
+         c_it->second.call!=*f_it)
       {
-        get_summary(SSA,n_it,f_it,summary_db.get(fname),
-		       forward,summaries,bindings);
+        call_site_instancet &instance = call_site_cache[call_site];
+        instance.version = version;
+        instance.call = *f_it;
+        instance.summaries.clear();
+        instance.bindings.clear();
+        get_summary(SSA,n_it,f_it,*summary,
+		    forward,instance.summaries,instance.bindings);
+        c_it = call_site_cache.find(call_site);
       }
+      summaries.insert(summaries.end(),
+        c_it->second.summaries.begin(),c_it->second.summaries.end());
+      bindings.insert(bindings.end(),
+        c_it->second.bindings.begin(),c_it->second.bindings.end());
     }
   }
 }
@@ -169,7 +190,7 @@ void ssa_inlinert::replace(local_SSAt &SSA,
 
       if(summary_db.exists(fname)) 
       {
-        summaryt summary = summary_db.get(fname);
+        const summaryt &summary = summary_db.get(fname);
 
         status() << "Replacing function " << fname << " by summary" << eom;
 
@@ -247,8 +268,7 @@ void ssa_inlinert::replace(local_SSAt &SSA,
           for(local_SSAt::nodest::const_iterator fn_it = fSSA.nodes.begin();
 	      fn_it != fSSA.nodes.end(); fn_it++)
 	  {
-            debug() << "new node: "; fn_it->output(debug(),fSSA.ns); 
-            debug() << eom;
+            debug() << "new node: " << lazy_output(*fn_it,fSSA.ns) << eom;
 
             new_nodes.push_back(*fn_it);
 	  }
@@ -38,6 +38,9 @@ class ssa_inlinert : public messaget
 		     exprt::operandst &bindings);
   exprt get_summaries(const local_SSAt &SSA);
 
+  // drops all cached summary instances
+  void clear_cache() { call_site_cache.clear(); }
+
   void replace(local_SSAt &SSA,
 	       local_SSAt::nodest::iterator node,
                local_SSAt::nodet::function_callst::iterator f_it, 
@@ -97,6 +100,20 @@ class ssa_inlinert : public messaget
   unsigned counter;
   summary_dbt &summary_db;
 
+  // summary instances (renamed to the call site) are cached
+  //  per call site and recomputed if the callee summary changes
+  struct call_site_instancet
+  {
+    unsigned version;
+    function_application_exprt call;
+    exprt::operandst summaries, bindings;
+  };
+  // (node, index of the call in the node, forward)
+  typedef std::pair<const local_SSAt::nodet *, 
+                    std::pair<unsigned, bool> > call_sitet;
+  typedef std::map<call_sitet, call_site_instancet> call_site_cachet;
+  call_site_cachet call_site_cache;
+
   local_SSAt::nodest new_nodes;
   local_SSAt::nodet::equalitiest new_equs;
   std::set<local_SSAt::nodet::function_callst::iterator> rm_function_calls;
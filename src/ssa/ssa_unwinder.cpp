@@ -9,6 +9,9 @@ Author: Peter Schrammel, Saurabh Joshi
 //#define DEBUG
 
 #include <util/prefix.h>
+#include <util/string2int.h>
+
+#include "../domains/profiling.h"
 
 #include "ssa_unwinder.h"
 
@@ -295,7 +298,75 @@ void ssa_local_unwindert::unwind(unsigned k)
   //update current unwinding
   for(loop_mapt::iterator it = loops.begin(); it != loops.end(); ++it)
   {
-    it->second.current_unwinding=k;
+    it->second.current_unwinding=get_unwinding(it->second,k);
+  }
+}
+
+/*****************************************************************************
+ *
+ *  Function : ssa_local_unwindert::get_unwinding
+ *
+ *  Input : 
+ *
+ *  Output : 
+ *
+ *  Purpose : unwinding of the given loop when unwinding the function to k:
+ *            bounded by the unwindset, exhausted loops stay where they are
+ *
+ *****************************************************************************/
+
+unsigned ssa_local_unwindert::get_unwinding(const loopt &loop, unsigned k) const
+{
+  if(loop.is_exhausted && loop.current_unwinding>=0)
+    return loop.current_unwinding;
+  if(loop.max_unwinding>=0 && k>loop.max_unwinding)
+    return loop.max_unwinding;
+  return k;
+}
+
+/*****************************************************************************
+ *
+ *  Function : ssa_local_unwindert::is_bounded
+ *
+ *  Input : 
+ *
+ *  Output : 
+ *
+ *  Purpose : 
+ *
+ *****************************************************************************/
+
+bool ssa_local_unwindert::is_bounded(unsigned k) const
+{
+  for(loop_mapt::const_iterator it = loops.begin(); it != loops.end(); ++it)
+  {
+    if(it->second.max_unwinding<0 || k<it->second.max_unwinding)
+      return false;
+  }
+  return true;
+}
+
+/*****************************************************************************
+ *
+ *  Function : ssa_local_unwindert::set_unwindset
+ *
+ *  Input : 
+ *
+ *  Output : 
+ *
+ *  Purpose : loops are identified as in the goto program: function.number
+ *
+ *****************************************************************************/
+
+void ssa_local_unwindert::set_unwindset(const unwindsett &unwindset)
+{
+  for(loop_mapt::iterator it = loops.begin(); it != loops.end(); ++it)
+  {
+    irep_idt loop_id = id2string(fname)+"."+
+      i2string(it->second.body_nodes.back().location->loop_number);
+    unwindsett::const_iterator u_it = unwindset.find(loop_id);
+    if(u_it != unwindset.end())
+      it->second.max_unwinding = u_it->second;
   }
 }
 
@@ -308,7 +379,7 @@ void ssa_local_unwindert::unwind(unsigned k)
  *  Output : 
  *
  *  Purpose : unwind all instances of given loop up to k 
-              starting from previous unwindings,
+              (or its own bound) starting from previous unwindings,
               and recurse
  *
  *****************************************************************************/
@@ -316,13 +387,14 @@ void ssa_local_unwindert::unwind(unsigned k)
 void ssa_local_unwindert::unwind(loopt &loop, unsigned k, bool is_new_parent)
 {
   odometert context = SSA.current_unwindings;
+  unsigned loop_k = get_unwinding(loop,k);
 #ifdef DEBUG
-  std::cout << "unwind(k=" << k << ", is_new_parent=" << is_new_parent << "), ";
+  std::cout << "unwind(k=" << loop_k << ", is_new_parent=" << is_new_parent << "), ";
   std::cout << "context=" << SSA.odometer_to_string(context,context.size()) 
 	    << std::endl;
 #endif
   SSA.increment_unwindings(1);
-  for(unsigned i = 0; i<=k; ++i)
+  for(unsigned i = 0; i<=loop_k; ++i)
   {
     //add new unwindings of this loop
     if(i>loop.current_unwinding || is_new_parent)
@@ -353,7 +425,7 @@ void ssa_local_unwindert::unwind(loopt &loop, unsigned k, bool is_new_parent)
       add_assertions(loop,is_last);
       add_hoisted_assertions(loop,is_last);
     }
-    if(i==k)
+    if(i==loop_k)
     {
       add_loop_head(loop);
       //update loop head
@@ -380,7 +452,7 @@ void ssa_local_unwindert::unwind(loopt &loop, unsigned k, bool is_new_parent)
     SSA.increment_unwindings(0);
   }
   SSA.increment_unwindings(-1);
-  add_exit_merges(loop,k);
+  add_exit_merges(loop,loop_k);
 }
 
 /*****************************************************************************
@@ -695,6 +767,31 @@ void ssa_local_unwindert::loop_continuation_conditions(
   }
 }
 
+/*****************************************************************************\
+ *
+ * Function : ssa_local_unwindert::loop_continuation_conditions
+ *
+ * Input :
+ *
+ * Output :
+ *
+ * Purpose : return loop continuation conditions separately for each loop
+ *
+ *****************************************************************************/
+
+void ssa_local_unwindert::loop_continuation_conditions(
+  loop_continuest& loop_conts) const
+{
+  SSA.current_unwindings.clear();
+  for(loop_mapt::const_iterator it = loops.begin(); it != loops.end(); ++it)
+  {
+    if(!it->second.is_root)
+      continue;
+    loop_continuation_conditions(it->second,it->first,loop_conts); //recursive
+    assert(SSA.current_unwindings.empty());
+  }
+}
+
 /*****************************************************************************
  *
  *  Function : ssa_local_unwindert::get_continuation_condition
@@ -745,6 +842,36 @@ void ssa_local_unwindert::loop_continuation_conditions(
   SSA.increment_unwindings(-1);
 }
 
+/*****************************************************************************\
+ *
+ * Function : ssa_local_unwindert::loop_continuation_conditions
+ *
+ * Input :
+ *
+ * Output :
+ *
+ * Purpose : recursively construct loop continuation conditions
+ *           for all instances of each loop
+ *
+ *****************************************************************************/
+
+void ssa_local_unwindert::loop_continuation_conditions(
+  const loopt& loop, unsigned loop_head, loop_continuest& loop_conts) const
+{
+  SSA.increment_unwindings(1);
+  loop_conts[loop_head].push_back(get_continuation_condition(loop)); //%0
+  for(unsigned i=0; i<=loop.current_unwinding; ++i)
+  {
+    //recurse into child loops
+    for(std::vector<unsigned>::const_iterator l_it = loop.loop_nodes.begin();
+	l_it != loop.loop_nodes.end(); ++l_it)
+    {
+      loop_continuation_conditions(loops.at(*l_it),*l_it,loop_conts);
+    }
+    SSA.increment_unwindings(0);
+  }
+  SSA.increment_unwindings(-1);
+}
 
 /*****************************************************************************\
  *
@@ -772,6 +899,8 @@ void ssa_local_unwindert::loop_continuation_conditions(
  *          Note that if current_unwinding is X then suffixes can have at most
  *          X-1 in its parts
  *
+ *          The current unwinding is the one of the loop the node belongs to.
+ *
  *****************************************************************************/
 
 void ssa_local_unwindert::unwinder_rename(symbol_exprt &var,
@@ -791,7 +920,14 @@ void ssa_local_unwindert::unwinder_rename(symbol_exprt &var,
   if(pos==std::string::npos) return;
   size_t pos1 = id.find_last_of("%");
   std::string suffix;
-  unsigned unwinding = pre ? SSA.current_unwinding : 0;
+  //the node is either a loop head or a back edge
+  unsigned loop_head = node.loophead==SSA.nodes.end() ? 
+    node.location->location_number : 
+    node.loophead->location->location_number;
+  loop_mapt::const_iterator l_it = loops.find(loop_head);
+  long current_unwinding = l_it==loops.end() ? 
+    SSA.current_unwinding : l_it->second.current_unwinding;
+  unsigned unwinding = pre ? current_unwinding : 0;
   if(pos==pos1)
   {
      suffix = "%"+i2string(unwinding);
@@ -845,6 +981,7 @@ void ssa_unwindert::unwind(const irep_idt fname, unsigned int k)
 void ssa_unwindert::unwind_all(unsigned int k)
 {
   assert(is_initialized);
+  profile_scopet profile_scope("unwinding");
 
   for (unwinder_mapt::iterator it = unwinder_map.begin();
        it != unwinder_map.end(); it++) {
@@ -852,6 +989,59 @@ void ssa_unwindert::unwind_all(unsigned int k)
   }
 }
 
+/*****************************************************************************\
+ *
+ * Function : ssa_unwindert::is_bounded
+ *
+ * Input :
+ *
+ * Output : true if unwinding beyond k does not change any function
+ *
+ * Purpose :
+ *
+ *****************************************************************************/
+
+bool ssa_unwindert::is_bounded(unsigned k) const
+{
+  for(unwinder_mapt::const_iterator it = unwinder_map.begin();
+      it != unwinder_map.end(); it++)
+  {
+    if(!it->second.is_bounded(k))
+      return false;
+  }
+  return true;
+}
+
+/*****************************************************************************\
+ *
+ * Function : ssa_unwindert::set_unwindset
+ *
+ * Input : unwindset - comma-separated list of loop_id:k
+ *
+ * Output :
+ *
+ * Purpose : must be called before init_localunwinders
+ *
+ *****************************************************************************/
+
+void ssa_unwindert::set_unwindset(const std::string &_unwindset)
+{
+  unwindset.clear();
+  std::string::size_type start = 0;
+  while(start<_unwindset.size())
+  {
+    std::string::size_type end = _unwindset.find(',',start);
+    if(end==std::string::npos) end = _unwindset.size();
+    std::string entry = _unwindset.substr(start,end-start);
+    start = end+1;
+
+    std::string::size_type colon = entry.rfind(':');
+    if(colon==std::string::npos) continue;
+    unwindset[entry.substr(0,colon)] = 
+      unsafe_string2unsigned(entry.substr(colon+1));
+  }
+}
+
 /*****************************************************************************\
  *
  * Function : ssa_unwindert::init
@@ -896,6 +1086,7 @@ void ssa_unwindert::init_localunwinders()
       it!=unwinder_map.end();it++)
   {
     it->second.init();
+    it->second.set_unwindset(unwindset);
   }
   is_initialized = true;
 }
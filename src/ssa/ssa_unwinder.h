@@ -17,6 +17,10 @@ class ssa_local_unwindert
 public:
   typedef local_SSAt::locationt locationt;
   typedef unwindable_local_SSAt::odometert odometert;
+  // loop id (function.loop_number) -> maximum unwinding
+  typedef std::map<irep_idt,unsigned> unwindsett;
+  // loop head location number -> continuation conditions
+  typedef std::map<unsigned,exprt::operandst> loop_continuest;
   
   ssa_local_unwindert(const irep_idt _fname, unwindable_local_SSAt& _SSA,
 		       bool _is_kinduction, bool _is_bmc)
@@ -28,16 +32,20 @@ public:
 
   void unwind(unsigned k);
 
-  //TODO: not yet sure how to do that
-/*  void unwind(locationt loop_head_loc, unsigned k)
-    { unwind(loops[loop_head_loc],k); } */
+  // per-loop bounds on the unwinding
+  void set_unwindset(const unwindsett &unwindset);
 
-  //TOOD: this should be loop specific in future, maybe move to unwindable_local_ssa as it is not really unwinder related
-  void loop_continuation_conditions(exprt::operandst& loop_cont) const;
+  // an exhausted loop is not unwound any further
+  //   until it is found to continue again
+  void set_exhausted(unsigned loop_head, bool exhausted)
+    { loops.at(loop_head).is_exhausted = exhausted; }
+  unsigned number_of_loops() const { return loops.size(); }
+  // true if no loop can be unwound beyond k
+  bool is_bounded(unsigned k) const;
 
-  //TODO: these two should be possible with unwindable_local_ssa facilities
-  //exprt rename_invariant(const exprt& inv_in) const; 
-  //void unwinder_rename(symbol_exprt &var,const local_SSAt::nodet &node, bool pre) const;
+  //TOOD: maybe move to unwindable_local_ssa as it is not really unwinder related
+  void loop_continuation_conditions(exprt::operandst& loop_cont) const;
+  void loop_continuation_conditions(loop_continuest& loop_conts) const;
 
   //TODO: this must go away, should use SSA.rename instead
   void unwinder_rename(symbol_exprt &var,
@@ -55,7 +63,9 @@ protected:
       :
     is_dowhile(false),
     is_root(false),
-    current_unwinding(-1)
+    is_exhausted(false),
+    current_unwinding(-1),
+    max_unwinding(-1)
     {}
 
     local_SSAt::nodest body_nodes;
@@ -64,7 +74,9 @@ protected:
     std::vector<unsigned> loop_nodes; //child loops
     bool is_dowhile;
     bool is_root;
+    bool is_exhausted;
     long current_unwinding;
+    long max_unwinding; //-1 if unbounded
     typedef std::map<exprt,exprt::operandst> exit_mapt;
     exit_mapt exit_map;
     std::map<symbol_exprt,symbol_exprt> pre_post_map;
@@ -90,10 +102,13 @@ protected:
   void build_exit_conditions();
 
   void unwind(loopt &loop, unsigned k, bool is_new_parent);
+  unsigned get_unwinding(const loopt &loop, unsigned k) const;
 
   exprt get_continuation_condition(const loopt& loop) const;
   void loop_continuation_conditions(const loopt& loop, 
 				    exprt::operandst &loop_cont) const;
+  void loop_continuation_conditions(const loopt& loop, unsigned loop_head,
+				    loop_continuest &loop_conts) const;
   
   void add_loop_body(loopt &loop);
   void add_assertions(loopt &loop, bool is_last);
@@ -117,19 +132,28 @@ public:
     ssa_db(_db), is_initialized(false)
   {}
 
+  // format: loop_id:k,loop_id:k,... as for --unwindset
+  void set_unwindset(const std::string &unwindset);
+
   void init(bool is_kinduction, bool is_bmc);
   void init_localunwinders();
 
   void unwind(const irep_idt fname, unsigned k);
   void unwind_all(unsigned k);
+  bool is_bounded(unsigned k) const;
 
   ssa_local_unwindert &get(const irep_idt& fname)
     { return unwinder_map.at(fname); }
 
+  // to be called before the SSA of the function is deleted
+  void erase(const irep_idt& fname)
+    { unwinder_map.erase(fname); }
+
 protected:
   ssa_dbt& ssa_db;
   bool is_initialized;
   unwinder_mapt unwinder_map;
+  ssa_local_unwindert::unwindsett unwindset;
 
 };
 
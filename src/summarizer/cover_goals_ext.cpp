@@ -9,7 +9,6 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <util/threeval.h>
 #include <solvers/prop/literal_expr.h>
 
-#include "../ssa/ssa_build_goto_trace.h"
 #include "cover_goals_ext.h"
 
 /*******************************************************************\
@@ -199,7 +198,7 @@ void cover_goals_extt::assignment()
 	if(build_error_trace)
 	{
 	  ssa_build_goto_tracet build_goto_trace(SSA,solver.get_solver());
-	  build_goto_trace(property_map[it->first].error_trace);
+	  build_goto_trace.take_snapshot(error_models[it->first]);
 	  if(!all_properties) 
 	    break;
 	}
@@ -228,7 +227,7 @@ void cover_goals_extt::assignment()
 	if(build_error_trace)
 	{
 	  ssa_build_goto_tracet build_goto_trace(SSA,solver.get_solver());
-	  build_goto_trace(property_map[it->first].error_trace);
+	  build_goto_trace.take_snapshot(error_models[it->first]);
 
 #if 0
           show_raw_countermodel(it->first,SSA,solver,debug(),get_message_handler());
@@ -252,3 +251,27 @@ void cover_goals_extt::assignment()
 
   _iterations++; //statistics
 }
+
+/*******************************************************************\
+
+Function: cover_goals_extt::build_error_traces
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: error traces are built from the model snapshots
+          after the goals have been covered
+
+\*******************************************************************/
+
+void cover_goals_extt::build_error_traces()
+{
+  for(error_modelst::iterator it=error_models.begin();
+      it!=error_models.end(); it++)
+  {
+    ssa_build_goto_tracet build_goto_trace(SSA,it->second);
+    build_goto_trace(property_map[it->first].error_trace);
+  }
+  error_models.clear();
+}
@@ -15,6 +15,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include "../ssa/local_ssa.h"
 #include "../ssa/unwindable_local_ssa.h"
 #include "../domains/incremental_solver.h"
+#include "../ssa/ssa_build_goto_trace.h"
 
 /*******************************************************************\
 
@@ -108,6 +109,9 @@ public:
     goals.push_back(cover_goalt());
     goals.back().condition=condition;
   }
+
+  // turns the model snapshots of failed properties into error traces
+  void build_error_traces();
   
 protected:
   unwindable_local_SSAt &SSA;
@@ -117,6 +121,10 @@ protected:
   bool spurious_check, all_properties, build_error_trace;
   exprt::operandst loophead_selects;
 
+  // the error traces are only built after covering the goals
+  typedef std::map<irep_idt, ssa_trace_modelt> error_modelst;
+  error_modelst error_models;
+
   // this method is called for each satisfying assignment
   virtual void assignment();
 
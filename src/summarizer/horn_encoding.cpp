@@ -9,7 +9,19 @@ Date: June 2015
 \*******************************************************************/
 
 #include <ostream>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
 
+#include <util/tempfile.h>
+#include <util/i2string.h>
 #include <solvers/smt2/smt2_conv.h>
 
 #include "../ssa/local_ssa.h"
@@ -29,11 +41,15 @@ class horn_encodingt
 public:
   horn_encodingt(
     const goto_modelt &_goto_model,
-    std::ostream &_out):
+    std::ostream &_out,
+    bool _compact,
+    unsigned _jobs):
     goto_functions(_goto_model.goto_functions),
     ns(_goto_model.symbol_table),
     out(_out),
-    smt2_conv(ns, "", "Horn-clause encoding", "", smt2_convt::Z3, _out)
+    smt2_conv(ns, "", "Horn-clause encoding", "", smt2_convt::Z3, _out),
+    compact(_compact),
+    jobs(_jobs==0 ? 1 : _jobs)
   {
   }
   
@@ -45,8 +61,76 @@ protected:
   std::ostream &out;
   
   smt2_convt smt2_conv;
+
+  bool compact;
+  unsigned jobs;
+
+  typedef std::vector<goto_functionst::function_mapt::const_iterator> 
+    functionst;
   
   void translate(const goto_functionst::function_mapt::const_iterator);
+
+  // large-block encoding: predicates only at loop heads and function exit
+  class loopt
+  {
+  public:
+    unsigned head_number, end_number;
+    symbol_exprt select;
+    std::vector<symbol_exprt> context_vars;
+    std::vector<symbol_exprt> pre_vars;
+    exprt::operandst post_vars;
+    exprt post_guard;
+  };
+  typedef std::vector<loopt> loopst;
+
+  class function_encodingt
+  {
+  public:
+    std::string name;
+    exprt::operandst equalities, constraints, assertions;
+    std::vector<unsigned> equality_locs, constraint_locs, assertion_locs;
+    std::map<irep_idt, unsigned> definitions;
+    loopst loops;
+    std::map<irep_idt, unsigned> loop_symbols; // select and loop-back vars
+    std::vector<symbol_exprt> exit_vars;
+    exprt exit_guard;
+    unsigned exit_number;
+  };
+
+  void translate_compact(
+    const goto_functionst::function_mapt::const_iterator,
+    std::ostream &dest);
+  void translate_compact_parallel(const functionst &functions);
+
+  void build_function_encoding(
+    const local_SSAt &SSA,
+    function_encodingt &f);
+
+  void loop_predicate_args(
+    const loopt &loop,
+    const exprt &select,
+    const exprt::operandst &vars,
+    exprt::operandst &args);
+
+  void output_clause(
+    smt2_convt &conv,
+    std::ostream &dest,
+    const function_encodingt &f,
+    const exprt &cond,
+    unsigned location_number,
+    const std::string &head_name,
+    const exprt::operandst &head_args);
+
+  void output_predicate(
+    smt2_convt &conv,
+    std::ostream &dest,
+    const std::string &name,
+    const exprt::operandst &args);
+
+  void output_forall(
+    smt2_convt &conv,
+    std::ostream &dest,
+    const std::map<irep_idt, typet> &vars);
 };
 
 /*******************************************************************\
@@ -63,8 +147,25 @@ Function: horn_encodingt::operator()
 
 void horn_encodingt::operator()()
 {
+  if(!compact)
+  {
+    forall_goto_functions(f_it, goto_functions)
+      translate(f_it);
+    return;
+  }
+
+  functionst functions;
   forall_goto_functions(f_it, goto_functions)
-    translate(f_it);
+    if(!f_it->second.body.empty())
+      functions.push_back(f_it);
+
+  if(jobs<=1 || functions.size()<=1)
+  {
+    for(unsigned i=0; i<functions.size(); i++)
+      translate_compact(functions[i], out);
+  }
+  else
+    translate_compact_parallel(functions);
 }
 
 /*******************************************************************\
@@ -238,6 +339,614 @@ void horn_encodingt::translate(
 
 /*******************************************************************\
 
+Function: replace_nondets
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: turns nondet symbols into ordinary symbols that can be
+          quantified
+
+\*******************************************************************/
+
+static void replace_nondets(exprt &expr)
+{
+  if(expr.id()==ID_nondet_symbol)
+  {
+    expr=symbol_exprt(expr.get(ID_identifier), expr.type());
+    return;
+  }
+
+  Forall_operands(it, expr)
+    replace_nondets(*it);
+}
+
+/*******************************************************************\
+
+Function: collect_symbols
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+static void collect_symbols(
+  const exprt &expr,
+  std::map<irep_idt, typet> &symbols)
+{
+  if(expr.id()==ID_symbol)
+  {
+    symbols.insert(std::make_pair(
+      to_symbol_expr(expr).get_identifier(), expr.type()));
+    return;
+  }
+
+  forall_operands(it, expr)
+    collect_symbols(*it, symbols);
+}
+
+/*******************************************************************\
+
+Function: horn_encodingt::build_function_encoding
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: collects the SSA of the function, the loops cut at their
+          loop-back variables and the variables that are live at
+          loop heads and at the function exit
+
+\*******************************************************************/
+
+void horn_encodingt::build_function_encoding(
+  const local_SSAt &SSA,
+  function_encodingt &f)
+{
+  std::set<irep_idt> inputs;
+  for(local_SSAt::var_listt::const_iterator it=SSA.params.begin();
+      it!=SSA.params.end(); it++)
+    inputs.insert(it->get_identifier());
+  for(local_SSAt::var_sett::const_iterator it=SSA.globals_in.begin();
+      it!=SSA.globals_in.end(); it++)
+    inputs.insert(it->get_identifier());
+
+  // the SSA and the symbols that are read
+  std::map<irep_idt, typet> uses;
+  for(local_SSAt::nodest::const_iterator n_it=SSA.nodes.begin();
+      n_it!=SSA.nodes.end(); n_it++)
+  {
+    unsigned loc=n_it->location->location_number;
+
+    for(local_SSAt::nodet::equalitiest::const_iterator
+        e_it=n_it->equalities.begin();
+        e_it!=n_it->equalities.end();
+        e_it++)
+    {
+      exprt e=*e_it;
+      replace_nondets(e);
+      if(e.op0().id()==ID_symbol)
+        f.definitions[to_symbol_expr(e.op0()).get_identifier()]=
+          f.equalities.size();
+      collect_symbols(e.op1(), uses);
+      f.equalities.push_back(e);
+      f.equality_locs.push_back(loc);
+    }
+
+    for(local_SSAt::nodet::constraintst::const_iterator
+        c_it=n_it->constraints.begin();
+        c_it!=n_it->constraints.end();
+        c_it++)
+    {
+      exprt c=*c_it;
+      replace_nondets(c);
+      collect_symbols(c, uses);
+      f.constraints.push_back(c);
+      f.constraint_locs.push_back(loc);
+    }
+
+    for(local_SSAt::nodet::assertionst::const_iterator
+        a_it=n_it->assertions.begin();
+        a_it!=n_it->assertions.end();
+        a_it++)
+    {
+      exprt a=*a_it;
+      replace_nondets(a);
+      f.assertions.push_back(a);
+      f.assertion_locs.push_back(loc);
+    }
+  }
+
+  // loops
+  for(local_SSAt::nodest::const_iterator n_it=SSA.nodes.begin();
+      n_it!=SSA.nodes.end(); n_it++)
+  {
+    if(n_it->loophead==SSA.nodes.end()) continue;
+
+    local_SSAt::locationt head=n_it->loophead->location;
+
+    f.loops.push_back(loopt());
+    loopt &loop=f.loops.back();
+    loop.head_number=head->location_number;
+    loop.end_number=n_it->location->location_number;
+    loop.select=SSA.name(SSA.guard_symbol(), 
+                         local_SSAt::LOOP_SELECT, n_it->location);
+    loop.post_guard=and_exprt(SSA.guard_symbol(n_it->location),
+                              SSA.cond_symbol(n_it->location));
+
+    // the objects modified in the loop that are live at the loop head
+    const ssa_domaint::phi_nodest &phi_nodes=
+      SSA.ssa_analysis[head].phi_nodes;
+    for(local_SSAt::objectst::const_iterator
+        o_it=SSA.ssa_objects.objects.begin();
+        o_it!=SSA.ssa_objects.objects.end();
+        o_it++)
+    {
+      if(phi_nodes.find(o_it->get_identifier())==phi_nodes.end())
+        continue;
+      symbol_exprt phi=SSA.name(*o_it, local_SSAt::PHI, head);
+      if(uses.find(phi.get_identifier())==uses.end())
+        continue;
+
+      loop.pre_vars.push_back(
+        SSA.name(*o_it, local_SSAt::LOOP_BACK, n_it->location));
+      loop.post_vars.push_back(SSA.read_rhs(*o_it, n_it->location));
+    }
+
+    // values that are defined before the loop and read in the loop
+    std::map<irep_idt, typet> loop_uses;
+    for(unsigned i=0; i<f.equalities.size(); i++)
+      if(f.equality_locs[i]>=loop.head_number && 
+         f.equality_locs[i]<=loop.end_number)
+        collect_symbols(f.equalities[i].op1(), loop_uses);
+    for(unsigned i=0; i<f.constraints.size(); i++)
+      if(f.constraint_locs[i]>=loop.head_number && 
+         f.constraint_locs[i]<=loop.end_number)
+        collect_symbols(f.constraints[i], loop_uses);
+
+    for(std::map<irep_idt, typet>::const_iterator it=loop_uses.begin();
+        it!=loop_uses.end(); it++)
+    {
+      std::map<irep_idt, unsigned>::const_iterator d_it=
+        f.definitions.find(it->first);
+      if((d_it!=f.definitions.end() && 
+          f.equality_locs[d_it->second]<loop.head_number) ||
+         inputs.find(it->first)!=inputs.end())
+        loop.context_vars.push_back(symbol_exprt(it->first, it->second));
+    }
+
+    unsigned index=f.loops.size()-1;
+    f.loop_symbols[loop.select.get_identifier()]=index;
+    for(unsigned i=0; i<loop.pre_vars.size(); i++)
+      f.loop_symbols[loop.pre_vars[i].get_identifier()]=index;
+  }
+
+  // function exit
+  goto_programt::const_targett last=
+    SSA.goto_function.body.instructions.end();
+  last--;
+  f.exit_number=last->location_number;
+  f.exit_guard=SSA.guard_symbol(last);
+  f.exit_vars.insert(f.exit_vars.end(), 
+                     SSA.params.begin(), SSA.params.end());
+  f.exit_vars.insert(f.exit_vars.end(), 
+                     SSA.globals_in.begin(), SSA.globals_in.end());
+  f.exit_vars.insert(f.exit_vars.end(), 
+                     SSA.globals_out.begin(), SSA.globals_out.end());
+}
+
+/*******************************************************************\
+
+Function: horn_encodingt::loop_predicate_args
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: arguments of a loop-head predicate: 
+          selector, loop-invariant context, loop variables
+
+\*******************************************************************/
+
+void horn_encodingt::loop_predicate_args(
+  const loopt &loop,
+  const exprt &select,
+  const exprt::operandst &vars,
+  exprt::operandst &args)
+{
+  args.push_back(select);
+  args.insert(args.end(), 
+              loop.context_vars.begin(), loop.context_vars.end());
+  args.insert(args.end(), vars.begin(), vars.end());
+}
+
+/*******************************************************************\
+
+Function: horn_encodingt::output_predicate
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void horn_encodingt::output_predicate(
+  smt2_convt &conv,
+  std::ostream &dest,
+  const std::string &name,
+  const exprt::operandst &args)
+{
+  if(args.empty())
+  {
+    dest << '|' << name << '|';
+    return;
+  }
+
+  dest << "(|" << name << '|';
+  for(unsigned i=0; i<args.size(); i++)
+  {
+    dest << ' ';
+    conv.convert_expr(args[i]);
+  }
+  dest << ')';
+}
+
+/*******************************************************************\
+
+Function: horn_encodingt::output_forall
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void horn_encodingt::output_forall(
+  smt2_convt &conv,
+  std::ostream &dest,
+  const std::map<irep_idt, typet> &vars)
+{
+  dest << "(forall (";
+  for(std::map<irep_idt, typet>::const_iterator it=vars.begin();
+      it!=vars.end(); it++)
+  {
+    if(it!=vars.begin()) dest << ' ';
+    dest << '(';
+    conv.convert_expr(symbol_exprt(it->first, it->second));
+    dest << ' ';
+    conv.convert_type(it->second);
+    dest << ')';
+  }
+  dest << ") ";
+}
+
+/*******************************************************************\
+
+Function: horn_encodingt::output_clause
+
+  Inputs: condition under which the head holds at the given location,
+          head predicate (empty name for false)
+
+ Outputs:
+
+ Purpose: outputs the clause with the part of the SSA the head and
+          the condition depend on (the cone of influence), where
+          loops are cut by their loop-head predicates
+
+\*******************************************************************/
+
+void horn_encodingt::output_clause(
+  smt2_convt &conv,
+  std::ostream &dest,
+  const function_encodingt &f,
+  const exprt &cond,
+  unsigned location_number,
+  const std::string &head_name,
+  const exprt::operandst &head_args)
+{
+  std::map<irep_idt, typet> vars;
+  std::set<unsigned> equalities, constraints, loops;
+
+  std::map<irep_idt, typet> symbols;
+  collect_symbols(cond, symbols);
+  for(unsigned i=0; i<head_args.size(); i++)
+    collect_symbols(head_args[i], symbols);
+
+  // assumptions before the location restrict all paths to it
+  for(unsigned i=0; i<f.constraints.size(); i++)
+  {
+    if(f.constraint_locs[i]>location_number) continue;
+    constraints.insert(i);
+    collect_symbols(f.constraints[i], symbols);
+  }
+
+  std::vector<irep_idt> worklist;
+  for(std::map<irep_idt, typet>::const_iterator it=symbols.begin();
+      it!=symbols.end(); it++)
+    if(vars.insert(*it).second) worklist.push_back(it->first);
+
+  while(!worklist.empty())
+  {
+    irep_idt id=worklist.back();
+    worklist.pop_back();
+
+    symbols.clear();
+
+    std::map<irep_idt, unsigned>::const_iterator d_it=
+      f.definitions.find(id);
+    if(d_it!=f.definitions.end() && equalities.insert(d_it->second).second)
+      collect_symbols(f.equalities[d_it->second], symbols);
+
+    std::map<irep_idt, unsigned>::const_iterator l_it=
+      f.loop_symbols.find(id);
+    if(l_it!=f.loop_symbols.end() && loops.insert(l_it->second).second)
+    {
+      const loopt &loop=f.loops[l_it->second];
+      collect_symbols(loop.select, symbols);
+      for(unsigned i=0; i<loop.context_vars.size(); i++)
+        collect_symbols(loop.context_vars[i], symbols);
+      for(unsigned i=0; i<loop.pre_vars.size(); i++)
+        collect_symbols(loop.pre_vars[i], symbols);
+    }
+
+    for(std::map<irep_idt, typet>::const_iterator it=symbols.begin();
+        it!=symbols.end(); it++)
+      if(vars.insert(*it).second) worklist.push_back(it->first);
+  }
+
+  dest << "(assert ";
+  if(!vars.empty())
+    output_forall(conv, dest, vars);
+
+  dest << "\n  (=> (and";
+  for(std::set<unsigned>::const_iterator it=loops.begin();
+      it!=loops.end(); it++)
+  {
+    const loopt &loop=f.loops[*it];
+    exprt::operandst args;
+    loop_predicate_args(loop, loop.select,
+      exprt::operandst(loop.pre_vars.begin(), loop.pre_vars.end()), args);
+    dest << "\n    ";
+    output_predicate(conv, dest, 
+      "h-"+f.name+"-"+i2string(loop.head_number), args);
+  }
+  for(std::set<unsigned>::const_iterator it=equalities.begin();
+      it!=equalities.end(); it++)
+  {
+    dest << "\n    ";
+    conv.convert_expr(f.equalities[*it]);
+  }
+  for(std::set<unsigned>::const_iterator it=constraints.begin();
+      it!=constraints.end(); it++)
+  {
+    dest << "\n    ";
+    conv.convert_expr(f.constraints[*it]);
+  }
+  dest << "\n    ";
+  conv.convert_expr(cond);
+  dest << ")\n    ";
+
+  if(head_name.empty())
+    dest << "false";
+  else
+    output_predicate(conv, dest, head_name, head_args);
+
+  dest << ')'; // =>
+  if(!vars.empty()) 
+    dest << ')'; // forall
+  dest << ")\n"; // assert
+}
+
+/*******************************************************************\
+
+Function: horn_encodingt::translate_compact
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: large-block encoding of a function: one predicate per
+          loop head over the variables live there, one for the
+          function exit, and one clause per loop, exit and assertion
+
+\*******************************************************************/
+
+void horn_encodingt::translate_compact(
+  const goto_functionst::function_mapt::const_iterator f_it,
+  std::ostream &dest)
+{
+  std::ostringstream buf;
+  smt2_convt conv(ns, "", "Horn-clause encoding", "", smt2_convt::Z3, buf);
+  buf.str(""); // the header has already been written
+
+  buf << "\n"
+         ";\n"
+         "; Function " << f_it->first << "\n"
+         ";\n";
+
+  // compute SSA
+  local_SSAt local_SSA(f_it->second, ns, "");
+
+  function_encodingt f;
+  f.name=id2string(f_it->first);
+  build_function_encoding(local_SSA, f);
+
+  // declare the predicates
+  for(unsigned l=0; l<f.loops.size(); l++)
+  {
+    const loopt &loop=f.loops[l];
+    buf << "(declare-fun |h-" << f.name << "-" << loop.head_number
+        << "| (Bool";
+    for(unsigned i=0; i<loop.context_vars.size(); i++)
+    {
+      buf << ' ';
+      conv.convert_type(loop.context_vars[i].type());
+    }
+    for(unsigned i=0; i<loop.pre_vars.size(); i++)
+    {
+      buf << ' ';
+      conv.convert_type(loop.pre_vars[i].type());
+    }
+    buf << ") Bool)\n";
+  }
+
+  buf << "(declare-fun |h-" << f.name << "-exit| (";
+  for(unsigned i=0; i<f.exit_vars.size(); i++)
+  {
+    if(i>0) buf << ' ';
+    conv.convert_type(f.exit_vars[i].type());
+  }
+  buf << ") Bool)\n";
+
+  // a deselected loop-head predicate holds trivially
+  for(unsigned l=0; l<f.loops.size(); l++)
+  {
+    const loopt &loop=f.loops[l];
+    exprt::operandst args;
+    loop_predicate_args(loop, false_exprt(),
+      exprt::operandst(loop.pre_vars.begin(), loop.pre_vars.end()), args);
+
+    std::map<irep_idt, typet> vars;
+    for(unsigned i=1; i<args.size(); i++)
+      collect_symbols(args[i], vars);
+
+    buf << "(assert ";
+    if(!vars.empty())
+      output_forall(conv, buf, vars);
+    output_predicate(conv, buf, 
+      "h-"+f.name+"-"+i2string(loop.head_number), args);
+    if(!vars.empty())
+      buf << ')';
+    buf << ")\n";
+  }
+
+  buf << '\n';
+
+  // loop iterations
+  for(unsigned l=0; l<f.loops.size(); l++)
+  {
+    const loopt &loop=f.loops[l];
+    buf << "; loop " << loop.head_number << "-" << loop.end_number << '\n';
+    exprt::operandst args;
+    loop_predicate_args(loop, true_exprt(), loop.post_vars, args);
+    output_clause(conv, buf, f, loop.post_guard, loop.end_number,
+      "h-"+f.name+"-"+i2string(loop.head_number), args);
+  }
+
+  // function exit
+  buf << "; exit\n";
+  output_clause(conv, buf, f, f.exit_guard, f.exit_number,
+    "h-"+f.name+"-exit",
+    exprt::operandst(f.exit_vars.begin(), f.exit_vars.end()));
+
+  // assertions
+  for(unsigned i=0; i<f.assertions.size(); i++)
+  {
+    buf << "; assertion at PC " << f.assertion_locs[i] << '\n';
+    output_clause(conv, buf, f, not_exprt(f.assertions[i]), 
+      f.assertion_locs[i], "", exprt::operandst());
+  }
+
+  dest << buf.str();
+}
+
+/*******************************************************************\
+
+Function: horn_encodingt::translate_compact_parallel
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: splits the functions into contiguous chunks that are
+          encoded by separate processes (the expression data
+          structures are not thread-safe); the results are
+          concatenated in the original order
+
+\*******************************************************************/
+
+void horn_encodingt::translate_compact_parallel(const functionst &functions)
+{
+#ifdef _WIN32
+  for(unsigned i=0; i<functions.size(); i++)
+    translate_compact(functions[i], out);
+#else
+  unsigned n=std::min(jobs, (unsigned)functions.size());
+  std::vector<std::string> files;
+  std::vector<pid_t> pids;
+
+  out.flush();
+  std::cout.flush();
+  std::cerr.flush();
+
+  for(unsigned j=0; j<n; j++)
+  {
+    files.push_back(get_temporary_file("horn_encoding", ".smt2"));
+    unsigned begin=j*functions.size()/n;
+    unsigned end=(j+1)*functions.size()/n;
+
+    pid_t pid=fork();
+    if(pid==0) // child
+    {
+      int status=0;
+      try
+      {
+        std::ofstream job_out(files[j].c_str());
+        for(unsigned i=begin; i<end; i++)
+          translate_compact(functions[i], job_out);
+        job_out.close();
+        if(!job_out) status=1;
+      }
+      catch(...)
+      {
+        status=1;
+      }
+      _exit(status);
+    }
+    else if(pid<0) // could not fork, do it ourselves
+    {
+      std::ofstream job_out(files[j].c_str());
+      for(unsigned i=begin; i<end; i++)
+        translate_compact(functions[i], job_out);
+    }
+    pids.push_back(pid);
+  }
+
+  bool failed=false;
+  for(unsigned j=0; j<n; j++)
+  {
+    if(pids[j]<=0) continue;
+    int status;
+    if(waitpid(pids[j], &status, 0)<0 ||
+       !WIFEXITED(status) || WEXITSTATUS(status)!=0)
+      failed=true;
+  }
+
+  for(unsigned j=0; j<n; j++)
+  {
+    if(!failed)
+    {
+      std::ifstream in(files[j].c_str());
+      out << in.rdbuf();
+    }
+    remove(files[j].c_str());
+  }
+
+  if(failed)
+    throw "Horn-clause encoding job failed";
+#endif
+}
+
+/*******************************************************************\
+
 Function: horn_encoding
 
   Inputs:
@@ -250,7 +959,9 @@ Function: horn_encoding
 
 void horn_encoding(
   const goto_modelt &goto_model,
-  std::ostream &out)
+  std::ostream &out,
+  bool compact,
+  unsigned jobs)
 {
-  horn_encodingt(goto_model, out)();
+  horn_encodingt(goto_model, out, compact, jobs)();
 }
@@ -15,6 +15,8 @@ Author:
 
 void horn_encoding(
   const goto_modelt &,
-  std::ostream &out);
+  std::ostream &out,
+  bool compact=false,
+  unsigned jobs=1);
 
 #endif
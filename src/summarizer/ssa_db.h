@@ -14,6 +14,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include "../ssa/local_ssa.h"
 #include "../ssa/unwindable_local_ssa.h"
 #include "../domains/incremental_solver.h"
+#include "../domains/tpolyhedra_domain.h"
 #include <goto-programs/goto_functions.h>
 
 class ssa_dbt
@@ -24,7 +25,7 @@ public:
   typedef std::map<function_namet, incremental_solvert*> solverst;
 
   explicit ssa_dbt(const optionst &_options) 
-    : options(_options)
+    : options(_options), the_ns(NULL)
     { }
   
   ~ssa_dbt() 
@@ -32,9 +33,8 @@ public:
     for(functionst::iterator it = store.begin();
         it != store.end(); it++)
       delete it->second;
-    for(solverst::iterator it = the_solvers.begin();
-        it != the_solvers.end(); it++)
-      delete it->second;
+    clear_solvers();
+    delete the_ns;
   }
 
   local_SSAt &get(const function_namet &function_name) const 
@@ -44,29 +44,70 @@ public:
   { 
     solverst::iterator it = the_solvers.find(function_name);
     if(it!=the_solvers.end()) return *(it->second);
-    the_solvers[function_name] = 
+    incremental_solvert *solver = 
       incremental_solvert::allocate(store.at(function_name)->ns,
 				    options.get_bool_option("refine"));
-    return *the_solvers.at(function_name); 
+    solver->set_gc_threshold(options.get_unsigned_int_option("solver-gc"));
+    the_solvers[function_name] = solver;
+    return *solver; 
   }
 
   functionst &functions() { return store; }
   solverst &solvers() { return the_solvers; }
 
+  // template row values of the last forward summary
+  tpolyhedra_domaint::row_value_mapt &row_values(
+    const function_namet &function_name)
+    { return the_row_values[function_name]; }
+
   bool exists(const function_namet &function_name) const  
     { return store.find(function_name)!=store.end(); }
 
+  // the SSAs refer to a copy of the namespace such that
+  //  they can be reused by later runs of the analysis
   void create(const function_namet &function_name, 
               const goto_functionst::goto_functiont &goto_function,
               const namespacet &ns) 
   { 
-    store[function_name] = new unwindable_local_SSAt(goto_function,ns);
+    if(the_ns==NULL)
+      the_ns = new namespacet(ns);
+    erase(function_name);
+    store[function_name] = new unwindable_local_SSAt(goto_function,*the_ns);
+  }
+
+  // drops the SSA, the solver and the row values of the function
+  void erase(const function_namet &function_name)
+  {
+    functionst::iterator f_it = store.find(function_name);
+    if(f_it!=store.end())
+    {
+      delete f_it->second;
+      store.erase(f_it);
+    }
+    solverst::iterator s_it = the_solvers.find(function_name);
+    if(s_it!=the_solvers.end())
+    {
+      delete s_it->second;
+      the_solvers.erase(s_it);
+    }
+    the_row_values.erase(function_name);
+  }
+
+  void clear_solvers()
+  {
+    for(solverst::iterator it = the_solvers.begin();
+        it != the_solvers.end(); it++)
+      delete it->second;
+    the_solvers.clear();
   }
 
  protected:
   const optionst &options;
   functionst store;
   solverst the_solvers;
+  namespacet *the_ns;
+  std::map<function_namet, tpolyhedra_domaint::row_value_mapt> 
+    the_row_values;
 };
 
 #endif
@@ -183,6 +183,7 @@ exprt summarizer_baset::compute_calling_context(
     options,ssa_db,ssa_unwinder.get(function_name));
   template_generator.set_message_handler(get_message_handler());
   template_generator(solver.next_domain_number(),SSA,n_it,f_it,forward);
+  template_generator.share_encoding(solver);
 
   // collect globals at call site
   std::map<local_SSAt::nodet::function_callst::const_iterator, local_SSAt::var_sett>
@@ -214,6 +215,7 @@ exprt summarizer_baset::compute_calling_context(
   //statistics
   solver_instances += analyzer.get_number_of_solver_instances();
   solver_calls += analyzer.get_number_of_solver_calls();
+  strategy_iterations += analyzer.get_number_of_iterations();
 
   solver.pop_context();
 
@@ -277,7 +279,7 @@ bool summarizer_baset::check_precondition(
 
   if(summary_db.exists(fname)) 
   {
-    summaryt summary = summary_db.get(fname);
+    const summaryt &summary = summary_db.get(fname);
     if(summary.mark_recompute) return false;
     if(!context_sensitive ||
        summary.fw_precondition.is_true())  //precondition trivially holds
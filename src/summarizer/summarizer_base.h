@@ -33,7 +33,9 @@ class summarizer_baset : public messaget
     ssa_inliner(_ssa_inliner),
     solver_instances(0),
     solver_calls(0),
-    summaries_used(0)
+    summaries_used(0),
+    strategy_iterations(0),
+    reused_invariant_rows(0)
   {}
 
   typedef summaryt::predicatet preconditiont;
@@ -49,6 +51,10 @@ class summarizer_baset : public messaget
   unsigned get_number_of_solver_instances() { return solver_instances; }
   unsigned get_number_of_solver_calls() { return solver_calls; }
   unsigned get_number_of_summaries_used() { return summaries_used; }
+  unsigned get_number_of_strategy_iterations() 
+    { return strategy_iterations; }
+  unsigned get_number_of_reused_invariant_rows() 
+    { return reused_invariant_rows; }
 
  protected:
   optionst &options;
@@ -95,6 +101,8 @@ class summarizer_baset : public messaget
   unsigned solver_instances;
   unsigned solver_calls;
   unsigned summaries_used;
+  unsigned strategy_iterations;
+  unsigned reused_invariant_rows;
 };
 
 
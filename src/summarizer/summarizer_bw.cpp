@@ -18,6 +18,8 @@ Author: Peter Schrammel
 #include "summary_db.h"
 
 #include "../domains/ssa_analyzer.h"
+#include "../domains/lazy_message.h"
+#include "../domains/profiling.h"
 #include "../domains/template_generator_summary.h"
 #include "../domains/template_generator_callingcontext.h"
 #include "../domains/template_generator_ranking.h"
@@ -121,8 +123,9 @@ void summarizer_bwt::compute_summary_rec(const function_namet &function_name,
   }
 
   // store summary in db
-  summary_db.put(function_name,summary);
+  summary_db.put(function_name,summary,SSA.ns);
 
+  if(message_enabled(*this,M_STATUS))
   {
     std::ostringstream out;
     out << std::endl << "Summary for function " << function_name << std::endl;
@@ -150,6 +153,7 @@ void summarizer_bwt::do_summary(const function_namet &function_name,
 				summaryt &summary,
 				bool context_sensitive)
 {
+  profile_scopet profile_scope("summarization", function_name);
   bool sufficient = options.get_bool_option("sufficient");
   status() << "Computing preconditions" << eom;
 
@@ -161,6 +165,7 @@ void summarizer_bwt::do_summary(const function_namet &function_name,
     options,ssa_db,ssa_unwinder.get(function_name));
   template_generator.set_message_handler(get_message_handler());
   template_generator(solver.next_domain_number(),SSA,false);
+  template_generator.share_encoding(solver);
 
   exprt::operandst c;
   c.push_back(old_summary.fw_precondition);
@@ -190,6 +195,7 @@ void summarizer_bwt::do_summary(const function_namet &function_name,
     //statistics
     solver_instances += analyzer.get_number_of_solver_instances();
     solver_calls += analyzer.get_number_of_solver_calls();
+    strategy_iterations += analyzer.get_number_of_iterations();
   }
   else // TODO: yet another workaround for ssa_analyzer not being able to handle empty templates properly
   {
@@ -348,7 +354,7 @@ bool summarizer_bwt::check_postcondition(
 
   if(!summary_db.exists(fname)) return true; //nothing to do
 
-  summaryt summary = summary_db.get(fname);
+  const summaryt &summary = summary_db.get(fname);
 
   if(summary.bw_precondition.is_nil()) return false; //there is work to do
 
@@ -454,6 +460,7 @@ exprt summarizer_bwt::compute_calling_context2(
     options,ssa_db,ssa_unwinder.get(function_name));
   template_generator.set_message_handler(get_message_handler());
   template_generator(solver.next_domain_number(),SSA,n_it,f_it,false);
+  template_generator.share_encoding(solver);
 
   // collect globals at call site
   std::map<local_SSAt::nodet::function_callst::const_iterator, local_SSAt::var_sett>
@@ -503,6 +510,7 @@ exprt summarizer_bwt::compute_calling_context2(
   //statistics
   solver_instances += analyzer.get_number_of_solver_instances();
   solver_calls += analyzer.get_number_of_solver_calls();
+  strategy_iterations += analyzer.get_number_of_iterations();
 
   return postcondition_call;
 }
@@ -19,6 +19,8 @@ Author: Peter Schrammel
 #include "summary_db.h"
 
 #include "../domains/ssa_analyzer.h"
+#include "../domains/lazy_message.h"
+#include "../domains/profiling.h"
 #include "../domains/template_generator_callingcontext.h"
 
 #include "../ssa/local_ssa.h"
@@ -87,8 +89,9 @@ void summarizer_bw_termt::compute_summary_rec(
   }
 
   // store summary in db
-  summary_db.put(function_name,summary);
+  summary_db.put(function_name,summary,SSA.ns);
 
+  if(message_enabled(*this,M_STATUS))
   {
     std::ostringstream out;
     out << std::endl << "Summary for function " << function_name << std::endl;
@@ -149,6 +152,7 @@ void summarizer_bw_termt::do_summary_term(const function_namet &function_name,
 				summaryt &summary,
 				bool context_sensitive)
 {
+  profile_scopet profile_scope("summarization", function_name);
   status() << "Computing preconditions for termination" << eom;
 
   // solver
@@ -166,6 +170,7 @@ void summarizer_bw_termt::do_summary_term(const function_namet &function_name,
     options,ssa_db,ssa_unwinder.get(function_name));
   template_generator2.set_message_handler(get_message_handler());
   template_generator2(solver.next_domain_number(),SSA,false);
+  template_generator2.share_encoding(solver);
 
   exprt::operandst bindings;
   exprt::operandst postcond;
@@ -367,6 +372,7 @@ exprt summarizer_bw_termt::compute_termination_argument(
   //statistics
   solver_instances += analyzer.get_number_of_solver_instances();
   solver_calls += analyzer.get_number_of_solver_calls();
+  strategy_iterations += analyzer.get_number_of_iterations();
 
   return termination_argument;
 }
@@ -406,6 +412,7 @@ exprt summarizer_bw_termt::compute_precondition(local_SSAt &SSA,
     //statistics
     solver_instances += analyzer.get_number_of_solver_instances();
     solver_calls += analyzer.get_number_of_solver_calls();
+    strategy_iterations += analyzer.get_number_of_iterations();
   }
   else // TODO: yet another workaround for ssa_analyzer not being able to handle empty templates properly
   {
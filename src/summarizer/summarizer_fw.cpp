@@ -18,6 +18,8 @@ Author: Peter Schrammel
 #include "summary_db.h"
 
 #include "../domains/ssa_analyzer.h"
+#include "../domains/lazy_message.h"
+#include "../domains/profiling.h"
 #include "../domains/template_generator_summary.h"
 #include "../domains/template_generator_callingcontext.h"
 
@@ -89,9 +91,10 @@ void summarizer_fwt::compute_summary_rec(const function_namet &function_name,
 #endif
 
   // store summary in db
-  summary_db.put(function_name,summary);
+  summary_db.put(function_name,summary,SSA.ns);
 
-  if(!options.get_bool_option("competition-mode"))
+  if(!options.get_bool_option("competition-mode") &&
+     message_enabled(*this,M_STATUS))
   {
     std::ostringstream out;
     out << std::endl << "Summary for function " << function_name << std::endl;
@@ -118,11 +121,13 @@ void summarizer_fwt::do_summary(const function_namet &function_name,
 				exprt cond,
 				bool context_sensitive)
 {
+  profile_scopet profile_scope("summarization", function_name);
   status() << "Computing summary" << eom;
 
   // solver
   incremental_solvert &solver = ssa_db.get_solver(function_name);
   solver.set_message_handler(get_message_handler());
+  solver.collect_garbage();
 
   //analyze
   ssa_analyzert analyzer;
@@ -132,6 +137,19 @@ void summarizer_fwt::do_summary(const function_namet &function_name,
     options,ssa_db,ssa_unwinder.get(function_name));
   template_generator.set_message_handler(get_message_handler());
   template_generator(solver.next_domain_number(),SSA,true);
+  template_generator.share_encoding(solver);
+
+  // the invariant of the previous unwinding bounds the row values
+  tpolyhedra_domaint *tpolyhedra_domain = 
+    dynamic_cast<tpolyhedra_domaint *>(template_generator.domain());
+  if(tpolyhedra_domain!=NULL)
+  {
+    unsigned bounded = 
+      tpolyhedra_domain->bound_rows(ssa_db.row_values(function_name));
+    if(bounded>0)
+      debug() << bounded << " template row(s) bounded by previous result" 
+              << eom;
+  }
 
   exprt::operandst conds;
   conds.reserve(5);
@@ -139,28 +157,34 @@ void summarizer_fwt::do_summary(const function_namet &function_name,
   conds.push_back(summary.fw_precondition);
   conds.push_back(ssa_inliner.get_summaries(SSA));
 
-#ifdef REUSE_INVARIANTS
-  if(summary_db.exists(function_name)) //reuse existing invariants
+  // assume the invariant of the previous unwinding;
+  //   calling contexts may change in between
+  if(options.get_bool_option("reuse-invariants") && 
+     !context_sensitive && tpolyhedra_domain!=NULL)
   {
-    const exprt &old_inv = summary_db.get(function_name).fw_invariant;
-    exprt inv = ssa_unwinder.get(function_name).rename_invariant(old_inv);
+    exprt inv = tpolyhedra_domain->get_row_value_invariant(
+      ssa_db.row_values(function_name));
     conds.push_back(inv);
+    if(inv.id()==ID_and) 
+      reused_invariant_rows += inv.operands().size();
+    else if(!inv.is_true()) 
+      reused_invariant_rows++;
 
 #if 0
-    std::ostringstream out;
-    out << "(original inv)" << from_expr(SSA.ns,"",old_inv) << "\n";
-    debug() << out.str() << eom;
-    out << "(renamed inv)" << from_expr(SSA.ns,"",inv)<<"\n";
-    debug() << out.str() << eom;
+    debug() << "(renamed inv) " << from_expr(SSA.ns,"",inv) << eom;
 #endif
   }
-#endif
 
   cond = conjunction(conds);
 
   analyzer(solver,SSA,cond,template_generator);
   analyzer.get_result(summary.fw_transformer,template_generator.inout_vars());
   analyzer.get_result(summary.fw_invariant,template_generator.loop_vars());
+  if(tpolyhedra_domain!=NULL && analyzer.get_value()!=NULL)
+    tpolyhedra_domain->get_row_values(
+      static_cast<const tpolyhedra_domaint::templ_valuet &>(
+        *analyzer.get_value()),
+      ssa_db.row_values(function_name));
 
 #ifdef SHOW_WHOLE_RESULT
   // to see all the custom template values
@@ -179,6 +203,7 @@ void summarizer_fwt::do_summary(const function_namet &function_name,
 
   solver_instances += analyzer.get_number_of_solver_instances();
   solver_calls += analyzer.get_number_of_solver_calls();
+  strategy_iterations += analyzer.get_number_of_iterations();
 }
 
 /*******************************************************************\
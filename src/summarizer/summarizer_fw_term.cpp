@@ -18,6 +18,8 @@ Author: Peter Schrammel
 #include "summary_db.h"
 
 #include "../domains/ssa_analyzer.h"
+#include "../domains/lazy_message.h"
+#include "../domains/profiling.h"
 #include "../domains/template_generator_summary.h"
 #include "../domains/template_generator_callingcontext.h"
 #include "../domains/template_generator_ranking.h"
@@ -53,6 +55,7 @@ void summarizer_fw_termt::compute_summary_rec(
 
   status() << "Analyzing function "  << function_name << eom;
 
+  if(message_enabled(*this,M_DEBUG))
   {
     std::ostringstream out;
     out << "Function body for " << function_name << 
@@ -132,15 +135,11 @@ void summarizer_fw_termt::compute_summary_rec(
     }  
   }
 
-  {
-    std::ostringstream out;
-    out << std::endl << "Summary for function " << function_name << std::endl;
-    summary.output(out,SSA.ns);   
-    status() << out.str() << eom;
-  }
+  status() << std::endl << "Summary for function " << function_name 
+           << std::endl << lazy_output(summary,SSA.ns) << eom;
 
   // store summary in db
-  summary_db.put(function_name,summary);
+  summary_db.put(function_name,summary,SSA.ns);
 }
 
 /*******************************************************************\
@@ -229,6 +228,8 @@ void summarizer_fw_termt::do_nontermination(
 				      local_SSAt &SSA, 
 				      summaryt &summary)
 {
+  profile_scopet profile_scope("termination", function_name);
+
   // calling context, invariant, function call summaries
   exprt::operandst cond;
   if(!summary.fw_invariant.is_nil()) cond.push_back(summary.fw_invariant);
@@ -310,6 +311,7 @@ void summarizer_fw_termt::do_termination(const function_namet &function_name,
   //statistics
   solver_instances += analyzer1.get_number_of_solver_instances();
   solver_calls += analyzer1.get_number_of_solver_calls();
+  strategy_iterations += analyzer1.get_number_of_iterations();
 }
 
 /*******************************************************************\
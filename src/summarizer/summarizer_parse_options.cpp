@@ -9,13 +9,22 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <climits>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 #include <util/string2int.h>
 #include <util/config.h>
 #include <util/language.h>
 #include <util/options.h>
 #include <util/memory_info.h>
+#include <util/i2string.h>
 
 #include <ansi-c/ansi_c_language.h>
 #include <cpp/cpp_language.h>
@@ -25,6 +34,7 @@ Author: Daniel Kroening, kroening@kroening.com
 #include <goto-programs/set_properties.h>
 #include <goto-programs/remove_function_pointers.h>
 #include <goto-programs/read_goto_binary.h>
+#include <goto-programs/write_goto_binary.h>
 #include <goto-programs/loop_ids.h>
 #include <goto-programs/link_to_library.h>
 #include <goto-programs/goto_inline.h>
@@ -44,11 +54,13 @@ Author: Daniel Kroening, kroening@kroening.com
 #include "version.h"
 
 #include "../ssa/malloc_ssa.h"
+#include "../domains/profiling.h"
 
 #include "summarizer_parse_options.h"
 #include "summary_db.h"
 #include "summary_checker_ai.h"
 #include "summary_checker_bmc.h"
+#include "summary_checker_kiki.h"
 #include "summary_checker_kind.h"
 #include "../ssa/split_loopheads.h"
 #include "show.h"
@@ -91,6 +103,10 @@ void summarizer_parse_optionst::eval_verbosity()
 {
   // this is our default verbosity
   int v=messaget::M_STATISTICS;
+
+  // the responses of the server go to stdout as well
+  if(cmdline.isset("server"))
+    v=messaget::M_ERROR;
   
   if(cmdline.isset("verbosity"))
   {
@@ -136,6 +152,10 @@ void summarizer_parse_optionst::get_command_line_options(optionst &options)
   if(cmdline.isset("unwind"))
     options.set_option("unwind", cmdline.get_value("unwind"));
 
+  if(cmdline.isset("unwind-schedule"))
+    options.set_option("unwind-schedule", 
+                       cmdline.get_value("unwind-schedule"));
+
   if(cmdline.isset("inline-partial"))
     options.set_option("inline-partial", cmdline.get_value("inline-partial"));
 
@@ -245,6 +265,12 @@ void summarizer_parse_optionst::get_command_line_options(optionst &options)
       options.set_option("enum-solver", true);
     else //if(cmdline.isset("binsearch-solver")) //default
       options.set_option("binsearch-solver", true);
+
+    // bound template rows by a cheap interval analysis
+    if(cmdline.isset("no-interval-preanalysis"))
+      options.set_option("interval-preanalysis", false);
+    else
+      options.set_option("interval-preanalysis", true);
   }
 
   // use incremental assertion checks
@@ -288,6 +314,33 @@ void summarizer_parse_optionst::get_command_line_options(optionst &options)
   }
   else options.set_option("max-inner-ranking-iterations",20);
 
+  // bound on the number of conjuncts/disjuncts in joined summaries
+  if(cmdline.isset("max-summary-size"))
+    options.set_option("max-summary-size", 
+		       cmdline.get_value("max-summary-size"));
+  else options.set_option("max-summary-size", 0);
+
+  if(cmdline.isset("solver-gc"))
+    options.set_option("solver-gc", cmdline.get_value("solver-gc"));
+  else options.set_option("solver-gc", 0);
+
+  if(cmdline.isset("reuse-invariants"))
+    options.set_option("reuse-invariants", true);
+
+  // relational template rows only for dependent variables
+  if(cmdline.isset("sparse-relations"))
+    options.set_option("sparse-relations", true);
+  if(cmdline.isset("max-relational-rows"))
+    options.set_option("max-relational-rows", 
+		       cmdline.get_value("max-relational-rows"));
+  else options.set_option("max-relational-rows", 0);
+
+  // number of processes for the compact Horn-clause encoding
+  if(cmdline.isset("threads"))
+    options.set_option("threads", cmdline.get_value("threads"));
+  else
+    options.set_option("threads", 1);
+
  // do k-induction refinement
   if(cmdline.isset("k-induction"))
   {
@@ -380,6 +433,9 @@ int summarizer_parse_optionst::doit()
   get_command_line_options(options);
 
   eval_verbosity();
+
+  profiler.enabled=
+    cmdline.isset("profile") || cmdline.isset("profile-chrome");
   
   //
   // Print a banner
@@ -488,20 +544,10 @@ int summarizer_parse_optionst::doit()
   
   try
   {
-    summary_checker_baset *summary_checker = NULL;
-    if(!options.get_bool_option("k-induction") && 
-       !options.get_bool_option("incremental-bmc"))
-       summary_checker = new summary_checker_ait(options);
-    if(options.get_bool_option("k-induction") && 
-       !options.get_bool_option("incremental-bmc")) 
-       summary_checker = new summary_checker_kindt(options);
-    if(!options.get_bool_option("k-induction") && 
-       options.get_bool_option("incremental-bmc")) 
-       summary_checker = new summary_checker_bmct(options);
-    
-    summary_checker->set_message_handler(get_message_handler());
-    summary_checker->simplify=!cmdline.isset("no-simplify");
-    summary_checker->fixed_point=!cmdline.isset("no-fixed-point");
+    if(cmdline.isset("server"))
+      return server(options, goto_model);
+
+    summary_checker_baset *summary_checker = new_summary_checker(options);
 
     int retval;
     if(cmdline.isset("show-vcc"))
@@ -519,10 +565,12 @@ int summarizer_parse_optionst::doit()
       namespacet ns(symbol_table);
       
       std::string out_file=cmdline.get_value("horn-encoding");
+      bool compact=cmdline.isset("horn-compact");
+      unsigned jobs=options.get_unsigned_int_option("threads");
       
       if(out_file=="-")
       {
-        horn_encoding(goto_model, std::cout);
+        horn_encoding(goto_model, std::cout, compact, jobs);
       }
       else
       {
@@ -539,7 +587,7 @@ int summarizer_parse_optionst::doit()
           return 1;
         }
         
-        horn_encoding(goto_model, out);
+        horn_encoding(goto_model, out, compact, jobs);
       }
         
       return 7;
@@ -579,6 +627,7 @@ int summarizer_parse_optionst::doit()
 
   clean_up:
     delete summary_checker;
+    output_profile();
     return retval;
   }
   
@@ -602,6 +651,223 @@ int summarizer_parse_optionst::doit()
   #endif
 }
 
+/*******************************************************************\
+
+Function: summarizer_parse_optionst::output_profile
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void summarizer_parse_optionst::output_profile()
+{
+  if(!profiler.enabled)
+    return;
+
+  if(cmdline.isset("profile"))
+  {
+    std::string file=cmdline.get_value("profile");
+    std::ofstream out(file.c_str());
+    if(out)
+      profiler.output_json(out);
+    else
+      warning() << "failed to write profile to `" << file << "'" << eom;
+  }
+
+  if(cmdline.isset("profile-chrome"))
+  {
+    std::string file=cmdline.get_value("profile-chrome");
+    std::ofstream out(file.c_str());
+    if(out)
+      profiler.output_chrome_trace(out);
+    else
+      warning() << "failed to write profile to `" << file << "'" << eom;
+  }
+}
+
+/*******************************************************************\
+
+Function: summarizer_parse_optionst::new_summary_checker
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: creates the checker selected by the options
+
+\*******************************************************************/
+
+summary_checker_baset *summarizer_parse_optionst::new_summary_checker(
+  optionst &options)
+{
+  summary_checker_baset *summary_checker = NULL;
+  if(!options.get_bool_option("k-induction") && 
+     !options.get_bool_option("incremental-bmc"))
+     summary_checker = new summary_checker_ait(options);
+  if(options.get_bool_option("k-induction") && 
+     !options.get_bool_option("incremental-bmc")) 
+     summary_checker = new summary_checker_kindt(options);
+  if(!options.get_bool_option("k-induction") && 
+     options.get_bool_option("incremental-bmc")) 
+     summary_checker = new summary_checker_bmct(options);
+  if(options.get_bool_option("k-induction") && 
+     options.get_bool_option("incremental-bmc")) 
+     summary_checker = new summary_checker_kikit(options);
+  
+  summary_checker->set_message_handler(get_message_handler());
+  summary_checker->simplify=!cmdline.isset("no-simplify");
+  summary_checker->fixed_point=!cmdline.isset("no-fixed-point");
+  return summary_checker;
+}
+
+/*******************************************************************\
+
+Function: summarizer_parse_optionst::server
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: answers queries read line by line from stdin,
+          keeping the goto model and the checker (with its
+          SSA, summaries and solvers) in memory;
+          one JSON object is written to stdout per query:
+
+            check [property]   result of all or the given property
+            summary function   the summary of the function
+            reload             re-read and re-process the input files,
+                               keeping the SSA and summaries of
+                               the unchanged functions
+            quit
+
+\*******************************************************************/
+
+int summarizer_parse_optionst::server(
+  optionst &options,
+  goto_modelt &goto_model)
+{
+  summary_checker_baset *summary_checker = NULL;
+  bool analyzed = false;
+  property_checkert::resultt result = property_checkert::UNKNOWN;
+  std::string line;
+
+  // the analysis always decides all properties,
+  //  the queries then select from the results
+  options.set_option("all-properties", true);
+
+  status() << "Server ready" << eom;
+
+  while(std::getline(std::cin, line))
+  {
+    std::istringstream in(line);
+    std::string command, argument;
+    in >> command >> argument;
+    if(command=="")
+      continue;
+    if(command=="quit")
+      break;
+
+    jsont response=jsont::json_object();
+    response["command"]=jsont::json_string(command);
+    
+    try
+    {
+      if(command=="reload")
+      {
+        // on error, the previous program is kept
+        goto_modelt new_model;
+        symbol_table.clear();
+        if(get_goto_program(options, new_model))
+          response["status"]=jsont::json_string("error");
+        else
+        {
+          unsigned kept=0;
+          if(summary_checker!=NULL && summary_checker->can_reload())
+            kept=summary_checker->reload(goto_model, new_model);
+          else
+          {
+            delete summary_checker;
+            summary_checker = NULL;
+            goto_model.symbol_table.swap(new_model.symbol_table);
+            goto_model.goto_functions.swap(new_model.goto_functions);
+          }
+          analyzed=false;
+          response["status"]=jsont::json_string("ok");
+          response["kept"]=jsont::json_number(i2string(kept));
+        }
+      }
+      else if(command=="check" || command=="summary")
+      {
+        // the first query after a reload runs the analysis
+        if(summary_checker==NULL)
+          summary_checker = new_summary_checker(options);
+        if(!analyzed)
+        {
+          result = (*summary_checker)(goto_model);
+          analyzed=true;
+        }
+
+        if(command=="check")
+        {
+          if(argument=="")
+            response["result"]=jsont::json_string(
+              property_checkert::as_string(result));
+          jsont &properties=response["properties"];
+          properties=jsont::json_array();
+          for(property_checkert::property_mapt::const_iterator
+                it=summary_checker->property_map.begin();
+              it!=summary_checker->property_map.end();
+              it++)
+          {
+            if(it->first=="" || (argument!="" && it->first!=argument))
+              continue;
+            jsont property=jsont::json_object();
+            property["property"]=jsont::json_string(id2string(it->first));
+            property["status"]=jsont::json_string(
+              property_checkert::as_string(it->second.result));
+            properties.array.push_back(property);
+          }
+        }
+        else 
+        {
+          const summary_dbt &summary_db=summary_checker->get_summary_db();
+          if(!summary_db.exists(argument))
+            response["status"]=jsont::json_string("no summary");
+          else
+          {
+            const namespacet ns(goto_model.symbol_table);
+            std::ostringstream out;
+            summary_db.get(argument).output(out, ns);
+            response["status"]=jsont::json_string("ok");
+            response["summary"]=jsont::json_string(out.str());
+          }
+        }
+      }
+      else
+        response["status"]=jsont::json_string("unknown command");
+    }
+
+    catch(const std::string error_msg)
+    {
+      response["status"]=jsont::json_string(error_msg);
+    }
+
+    catch(const char *error_msg)
+    {
+      response["status"]=jsont::json_string(error_msg);
+    }
+
+    std::cout << response << std::endl;
+  }
+
+  delete summary_checker;
+  return 0;
+}
+
 
 
 void summarizer_parse_optionst::type_stats_rec(
@@ -857,6 +1123,12 @@ bool summarizer_parse_optionst::get_goto_program(
     return true;
   }
 
+  profile_scopet profile_scope("goto program");
+
+  std::string cache_file=preprocessing_cache_file();
+  if(cache_file!="" && read_preprocessing_cache(cache_file, goto_model))
+    return false;
+
   try
   {
     if(cmdline.args.size()==1 &&
@@ -921,10 +1193,13 @@ bool summarizer_parse_optionst::get_goto_program(
     }
     else
     {
-    
-      if(parse()) return true;
-      if(typecheck()) return true;
-      if(final()) return true;
+      {
+        profile_scopet profile_scope("parsing");
+
+        if(parse()) return true;
+        if(typecheck()) return true;
+        if(final()) return true;
+      }
 
       // we no longer need any parse trees or language files
       clear_parse();
@@ -956,6 +1231,26 @@ bool summarizer_parse_optionst::get_goto_program(
 
     if(process_goto_program(options, goto_model))
       return true;
+
+    if(cache_file!="")
+    {
+      status() << "Writing preprocessed GOTO program to cache" << eom;
+      // concurrent runs must never read a partially written file:
+      //   write to a file of our own and move it into place
+      std::ostringstream tmp_file;
+#ifdef _WIN32
+      tmp_file << cache_file << ".tmp" << _getpid();
+#else
+      tmp_file << cache_file << ".tmp" << getpid();
+#endif
+      if(write_goto_binary(tmp_file.str(), goto_model.symbol_table, 
+                           goto_model.goto_functions, get_message_handler()) ||
+         std::rename(tmp_file.str().c_str(), cache_file.c_str())!=0)
+      {
+        std::remove(tmp_file.str().c_str());
+        warning() << "failed to write cache file `" << cache_file << "'" << eom;
+      }
+    }
   }
 
   catch(const char *e)
@@ -986,6 +1281,130 @@ bool summarizer_parse_optionst::get_goto_program(
 
 /*******************************************************************\
 
+Function: summarizer_parse_optionst::preprocessing_cache_file
+
+  Inputs:
+
+ Outputs: the name of the cache file, empty if not cached
+
+ Purpose: the name is a hash of the contents of the input files
+          and the options that affect the preprocessing;
+          note that files included by the sources are not hashed
+
+\*******************************************************************/
+
+std::string summarizer_parse_optionst::preprocessing_cache_file()
+{
+  if(!cmdline.isset("preprocessing-cache"))
+    return "";
+
+  // the debug outputs are produced during the preprocessing
+  if(cmdline.isset("show-parse-tree") ||
+     cmdline.isset("show-symbol-table") ||
+     cmdline.isset("show-loops") ||
+     cmdline.isset("show-properties") ||
+     cmdline.isset("show-goto-functions"))
+    return "";
+
+  static const char *preprocessing_options[]=
+  {
+    "function", "D", "I", "no-library", "no-arch", "arch",
+    "16", "32", "64", "LP64", "ILP64", "LLP64", "ILP32", "LP32",
+    "little-endian", "big-endian", "unsigned-char",
+    "i386-linux", "i386-macos", "i386-win32", "win32", "winx64",
+    "gcc", "ppc-macos", "floatbv", "fixedbv",
+    "bounds-check", "pointer-check", "div-by-zero-check",
+    "memory-leak-check", "signed-overflow-check",
+    "unsigned-overflow-check", "float-overflow-check", "nan-check",
+    "no-assertions", "no-assumptions", "error-label", "property",
+    "inline", "inline-main", "inline-partial", "k-induction",
+    "incremental-bmc", "no-propagation", "cover-assertions",
+    "array-abstraction", "string-abstraction", "competition-mode",
+    NULL
+  };
+
+  // FNV-1a
+  unsigned long long hash=14695981039346656037ULL;
+  std::string key=SUMMARIZER_VERSION;
+  for(unsigned i=0; preprocessing_options[i]!=NULL; i++)
+  {
+    if(!cmdline.isset(preprocessing_options[i]))
+      continue;
+    key+=std::string(" --")+preprocessing_options[i];
+    const std::list<std::string> &values=
+      cmdline.get_values(preprocessing_options[i]);
+    for(std::list<std::string>::const_iterator it=values.begin();
+        it!=values.end(); it++)
+      key+=" "+*it;
+  }
+  for(unsigned i=0; i<cmdline.args.size(); i++)
+    key+=" "+cmdline.args[i];
+  for(unsigned i=0; i<key.size(); i++)
+  {
+    hash^=(unsigned char)key[i];
+    hash*=1099511628211ULL;
+  }
+
+  for(unsigned i=0; i<cmdline.args.size(); i++)
+  {
+    std::ifstream in(cmdline.args[i].c_str(), std::ios::binary);
+    if(!in)
+      return ""; // let the front-end report the error
+    char c;
+    while(in.get(c))
+    {
+      hash^=(unsigned char)c;
+      hash*=1099511628211ULL;
+    }
+  }
+
+  std::ostringstream file;
+  file << cmdline.get_value("preprocessing-cache") << "/2ls-"
+       << std::hex << hash << ".gb";
+  return file.str();
+}
+
+/*******************************************************************\
+
+Function: summarizer_parse_optionst::read_preprocessing_cache
+
+  Inputs:
+
+ Outputs: true if the cached program has been read
+
+ Purpose:
+
+\*******************************************************************/
+
+bool summarizer_parse_optionst::read_preprocessing_cache(
+  const std::string &cache_file,
+  goto_modelt &goto_model)
+{
+  std::ifstream in(cache_file.c_str(), std::ios::binary);
+  if(!in)
+    return false;
+  in.close();
+
+  status() << "Reading preprocessed GOTO program from cache" << eom;
+
+  if(read_goto_binary(cache_file, goto_model, get_message_handler()))
+  {
+    warning() << "failed to read cache file `" << cache_file << "'" << eom;
+    goto_model.clear();
+    return false;
+  }
+
+  config.set_from_symbol_table(goto_model.symbol_table);
+
+  // the loop numbers are not stored in the binary
+  goto_model.goto_functions.update();
+  goto_model.goto_functions.compute_loop_numbers();
+
+  return true;
+}
+
+/*******************************************************************\
+
 Function: summarizer_parse_optionst::process_goto_program
 
   Inputs:
@@ -1000,6 +1419,8 @@ bool summarizer_parse_optionst::process_goto_program(
   const optionst &options,
   goto_modelt &goto_model)
 {
+  profile_scopet profile_scope("preprocessing");
+
   try
   {
     // do partial inlining
@@ -1522,6 +1943,12 @@ void summarizer_parse_optionst::help()
     " --termination                compute ranking functions to prove termination\n"
     " --k-induction                use k-induction\n"
     " --incremental-bmc            use incremental-bmc\n"
+    "                              (both: run them concurrently)\n"
+    " --unwind nr                  maximum unwinding for k-induction and incremental BMC\n"
+    " --unwindset L:nr,...         maximum unwinding for loop L (function.number)\n"
+    " --unwind-schedule s          unwinding depths to check: linear (default),\n"
+    "                              geometric, luby or a list nr,nr,...\n"
+    " --reuse-invariants           assume the loop invariants of the previous unwinding\n"
     " --preconditions              compute preconditions\n"
     " --sufficient                 sufficient preconditions (default: necessary)\n"
     " --context-sensitive          context-sensitive analysis from entry point\n"
@@ -1530,12 +1957,26 @@ void summarizer_parse_optionst::help()
     " --equalities                 use equalities and disequalities domain\n"
     " --zones                      use zone domain\n"
     " --octagons                   use octagon domain\n"
+    " --sparse-relations           relate only variables that depend on each other\n"
+    " --max-relational-rows n      bound the number of relational template rows\n"
     " --enum-solver                use solver based on model enumeration\n"
     " --binsearch-solver           use solver based on binary search\n"
+    " --no-interval-preanalysis    do not bound template rows by interval pre-analysis\n"
     " --arrays                     do not ignore array contents\n"
     " --lexicographic-ranking-function n          (default n=3)\n"
     " --monolithic-ranking-function\n"
     " --max-inner-ranking-iterations n           (default n=20)\n"
+    " --threads n                  use n processes for --horn-compact\n"
+    " --max-summary-size n         bound size of joined summaries (default n=0 unbounded)\n"
+    " --solver-gc n                rebuild a function's solver after n discarded contexts\n"
+    "\n"
+    "Output options:\n"
+    " --server                     answer queries from stdin, keeping the analysis in memory\n"
+    " --preprocessing-cache dir    reuse the preprocessed GOTO program for identical inputs and options\n"
+    " --horn-encoding file         output the program as Horn clauses\n"
+    " --horn-compact               Horn clauses only at loop heads and function exits\n"
+    " --profile file               write time and memory per analysis phase as JSON\n"
+    " --profile-chrome file        write the analysis phases in Chrome trace format\n"
     "\n"
     "Other options:\n"
     " --version                    show version and exit\n"
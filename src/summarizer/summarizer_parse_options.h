@@ -24,7 +24,7 @@ class optionst;
   "(xml-ui)" \
   "(function):" \
   "D:I:" \
-  "(depth):(context-bound):(unwind):" \
+  "(depth):(context-bound):(unwind):(unwindset):(unwind-schedule):" \
   "(bounds-check)(pointer-check)(div-by-zero-check)(memory-leak-check)" \
   "(signed-overflow-check)(unsigned-overflow-check)" \
   "(float-overflow-check)(nan-check)" \
@@ -38,20 +38,23 @@ class optionst;
   "(i386-linux)(i386-macos)(i386-win32)(win32)(winx64)(gcc)" \
   "(ppc-macos)(unsigned-char)" \
   "(havoc)(intervals)(zones)(octagons)(equalities)"\
-  "(enum-solver)(binsearch-solver)(arrays)"\
+  "(enum-solver)(binsearch-solver)(arrays)(no-interval-preanalysis)"\
   "(string-abstraction)(no-arch)(arch):(floatbv)(fixedbv)" \
   "(round-to-nearest)(round-to-plus-inf)(round-to-minus-inf)(round-to-zero)" \
   "(inline)(inline-main)(inline-partial):" \
   "(context-sensitive)(termination)" \
   "(lexicographic-ranking-function):(monolithic-ranking-function)" \
-  "(max-inner-ranking-iterations):" \
+  "(max-inner-ranking-iterations):(threads):(max-summary-size):(solver-gc):" \
+  "(reuse-invariants)(sparse-relations)(max-relational-rows):" \
   "(preconditions)(sufficient)" \
   "(show-locs)(show-vcc)(show-properties)(show-trace)(show-fixed-points)(show-stats)" \
   "(show-goto-functions)(show-guards)(show-defs)(show-ssa)(show-assignments)" \
   "(show-invariants)(std-invariants)" \
   "(property):(all-properties)(k-induction)(incremental-bmc)" \
   "(no-spurious-check)" \
-  "(no-simplify)(no-fixed-point)" \
+  "(no-simplify)(no-fixed-point)(server)(preprocessing-cache):" \
+  "(profile):(profile-chrome):" \
+  "(horn-encoding):(horn-compact)" \
   "(graphml-cex):(json-cex):" \
   "(no-spurious-check)(no-all-properties)" \
   "(competition-mode)(slice)(no-propagation)" \
@@ -82,9 +85,18 @@ protected:
   bool process_goto_program(
     const optionst &options,
     goto_modelt &goto_model);
+
+  std::string preprocessing_cache_file();
+  bool read_preprocessing_cache(
+    const std::string &cache_file,
+    goto_modelt &goto_model);
     
   bool set_properties(goto_modelt &);
 
+  summary_checker_baset *new_summary_checker(optionst &options);
+  void output_profile();
+  int server(optionst &options, goto_modelt &goto_model);
+
   void report_success();
   void report_failure();
 
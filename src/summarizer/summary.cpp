@@ -6,8 +6,13 @@ Author: Peter Schrammel
 
 \*******************************************************************/
 
+#include <map>
+
+#include <util/arith_tools.h>
+
 #include "summary.h"
 #include "../domains/util.h"
+#include "../domains/incremental_solver.h"
 
 #include <langapi/language_util.h>
 
@@ -77,17 +82,234 @@ void summaryt::output(std::ostream &out, const namespacet &ns) const
 
 /*******************************************************************\
 
-Function: summaryt::join()
+Function: collect_operands
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: flattens nested conjunctions or disjunctions
+
+\*******************************************************************/
+
+static void collect_operands(
+  const exprt &src,
+  const irep_idt &id,
+  exprt::operandst &dest)
+{
+  if(src.id()==id)
+  {
+    forall_operands(it, src)
+      collect_operands(*it, id, dest);
+  }
+  else
+    dest.push_back(src);
+}
+
+/*******************************************************************\
+
+Function: get_template_bound
 
   Inputs:
 
+ Outputs: true if src is a template row constraint
+          of the form [premise ==>] lhs <= bound
+
+ Purpose:
+
+\*******************************************************************/
+
+static bool get_template_bound(
+  const exprt &src,
+  exprt &premise,
+  exprt &lhs,
+  mp_integer &bound)
+{
+  const exprt *rel=&src;
+  premise=true_exprt();
+  if(src.id()==ID_implies)
+  {
+    premise=src.op0();
+    rel=&src.op1();
+  }
+  if(rel->id()!=ID_le || rel->op1().id()!=ID_constant)
+    return false;
+  if(to_integer(rel->op1(), bound))
+    return false;
+  lhs=rel->op0();
+  return true;
+}
+
+/*******************************************************************\
+
+Function: summaryt::compact
+
+  Inputs: a conjunction or disjunction, 
+          max_size: maximum number of operands (0 for unbounded),
+          ns: for solver checks if the syntactic compaction
+              does not meet the bound (NULL for none)
+
+ Outputs:
+
+ Purpose: flattens, removes duplicates, constants and
+          operands subsumed by other operands;
+          template rows over the same expression are merged
+          by keeping the strongest bound (conjunctions)
+          or the weakest bound (disjunctions);
+          if the result still exceeds max_size, operands implied
+          by the others are removed by solver checks;
+          only then it is over-approximated
+
+\*******************************************************************/
+
+void summaryt::compact(exprt &expr, unsigned max_size, const namespacet *ns)
+{
+  if(expr.id()!=ID_and && expr.id()!=ID_or)
+    return;
+  bool is_and=expr.id()==ID_and;
+  irep_idt dual_id=is_and ? ID_or : ID_and;
+
+  exprt::operandst operands;
+  collect_operands(expr, expr.id(), operands);
+
+  exprt::operandst result;
+  std::set<exprt> seen;
+  typedef std::map<std::pair<exprt, exprt>, unsigned> boundst;
+  boundst bounds; // (premise, lhs) -> index in result
+  for(exprt::operandst::const_iterator it=operands.begin();
+      it!=operands.end(); it++)
+  {
+    if(it->is_true() || it->is_false())
+    {
+      // neutral element
+      if(it->is_true()==is_and)
+        continue;
+      // absorbing element
+      expr=*it;
+      return;
+    }
+    if(!seen.insert(*it).second)
+      continue;
+
+    exprt premise, lhs;
+    mp_integer bound;
+    if(get_template_bound(*it, premise, lhs, bound))
+    {
+      std::pair<boundst::iterator, bool> b_it=bounds.insert(
+        std::make_pair(std::make_pair(premise, lhs), result.size()));
+      if(!b_it.second)
+      {
+        exprt &old=result[b_it.first->second];
+        exprt old_premise, old_lhs;
+        mp_integer old_bound;
+        get_template_bound(old, old_premise, old_lhs, old_bound);
+        if(is_and ? bound<old_bound : bound>old_bound)
+          old=*it;
+        continue;
+      }
+    }
+
+    result.push_back(*it);
+  }
+
+  // absorption: a && (a || b) = a, a || (a && b) = a
+  std::set<exprt> members(result.begin(), result.end());
+  exprt::operandst absorbed;
+  for(exprt::operandst::const_iterator it=result.begin();
+      it!=result.end(); it++)
+  {
+    bool subsumed=false;
+    if(it->id()==dual_id)
+    {
+      exprt::operandst sub;
+      collect_operands(*it, dual_id, sub);
+      for(exprt::operandst::const_iterator s_it=sub.begin();
+          s_it!=sub.end() && !subsumed; s_it++)
+        subsumed=members.find(*s_it)!=members.end();
+    }
+    if(!subsumed)
+      absorbed.push_back(*it);
+  }
+
+  if(max_size>0 && absorbed.size()>max_size && ns!=NULL)
+    remove_implied(absorbed, is_and, max_size, *ns);
+
+  if(max_size>0 && absorbed.size()>max_size)
+  {
+    if(is_and)
+      absorbed.resize(max_size); // drop the most recent conjuncts
+    else
+    {
+      expr=true_exprt();
+      return;
+    }
+  }
+
+  expr=is_and ? conjunction(absorbed) : disjunction(absorbed);
+}
+
+/*******************************************************************\
+
+Function: summaryt::remove_implied
+
+  Inputs: operands of a conjunction or disjunction
+
+ Outputs:
+
+ Purpose: removes the operands, newest first, that are implied
+          by the remaining ones (conjunction) or that imply
+          the remaining ones (disjunction) until max_size is met
+
+\*******************************************************************/
+
+void summaryt::remove_implied(
+  exprt::operandst &operands,
+  bool is_and,
+  unsigned max_size,
+  const namespacet &ns)
+{
+  incremental_solvert solver(ns);
+  for(unsigned i=operands.size(); i>0 && operands.size()>max_size; i--)
+  {
+    exprt::operandst others(operands);
+    others.erase(others.begin()+(i-1));
+    const exprt &operand=operands[i-1];
+
+    solver.new_context();
+    if(is_and)
+    {
+      solver << conjunction(others);
+      solver << not_exprt(operand);
+    }
+    else
+    {
+      solver << operand;
+      solver << not_exprt(disjunction(others));
+    }
+    bool implied=solver()==decision_proceduret::D_UNSATISFIABLE;
+    solver.pop_context();
+
+    if(implied)
+      operands.erase(operands.begin()+(i-1));
+  }
+}
+
+/*******************************************************************\
+
+Function: summaryt::join()
+
+  Inputs: max_size: bound on the number of conjuncts/disjuncts
+          of the over-approximating predicates (0 for unbounded),
+          ns: namespace for the solver checks (NULL for none)
+
  Outputs:
 
  Purpose:
 
 \*******************************************************************/
 
-void summaryt::combine_and(exprt &olde, const exprt &newe)
+void summaryt::combine_and(exprt &olde, const exprt &newe, unsigned max_size,
+                           const namespacet *ns)
 {
   if(olde.is_nil()) 
   {
@@ -97,10 +319,12 @@ void summaryt::combine_and(exprt &olde, const exprt &newe)
   {
     if(newe.is_nil()) return;
     olde = and_exprt(olde,newe);
+    compact(olde,max_size,ns);
   }
 }
 
-void summaryt::combine_or(exprt &olde, const exprt &newe)
+void summaryt::combine_or(exprt &olde, const exprt &newe, unsigned max_size,
+                          const namespacet *ns)
 {
   if(olde.is_nil()) 
   {
@@ -110,17 +334,20 @@ void summaryt::combine_or(exprt &olde, const exprt &newe)
   {
     if(newe.is_nil()) return;
     olde = or_exprt(olde,newe);
+    compact(olde,max_size,ns);
   }
 }
 
-void summaryt::join(const summaryt &new_summary)
+void summaryt::join(const summaryt &new_summary, unsigned max_size,
+                    const namespacet *ns)
 {
   assert(params == new_summary.params);
   assert(globals_in == new_summary.globals_in);
   assert(globals_out == new_summary.globals_out);
-  combine_or(fw_precondition,new_summary.fw_precondition);
-  combine_and(fw_transformer,new_summary.fw_transformer);
-  combine_and(fw_invariant,new_summary.fw_invariant);
+  // only over-approximations may be weakened to meet the size bound
+  combine_or(fw_precondition,new_summary.fw_precondition,max_size,ns);
+  combine_and(fw_transformer,new_summary.fw_transformer,max_size,ns);
+  combine_and(fw_invariant,new_summary.fw_invariant,max_size,ns);
   combine_and(bw_precondition,new_summary.bw_precondition);
   combine_or(bw_postcondition,new_summary.bw_postcondition);
   combine_and(bw_transformer,new_summary.bw_transformer);
@@ -57,12 +57,23 @@ class summaryt
 
   void output(std::ostream &out, const namespacet &ns) const;
 
-  void join(const summaryt &new_summary);
+  // max_size bounds the size of the over-approximating predicates
+  //  (0 for unbounded); if given, ns enables the solver checks
+  void join(const summaryt &new_summary, unsigned max_size=0,
+            const namespacet *ns=NULL);
+
+  static void compact(exprt &expr, unsigned max_size=0,
+                      const namespacet *ns=NULL);
 
  protected:
 
-  void combine_or(exprt &olde, const exprt &newe);
-  void combine_and(exprt &olde, const exprt &newe);
+  void combine_or(exprt &olde, const exprt &newe, unsigned max_size=0,
+                  const namespacet *ns=NULL);
+  void combine_and(exprt &olde, const exprt &newe, unsigned max_size=0,
+                   const namespacet *ns=NULL);
+
+  static void remove_implied(exprt::operandst &operands, bool is_and,
+                             unsigned max_size, const namespacet &ns);
 
 };
 
@@ -7,6 +7,7 @@ Author: Peter Schrammel
 \*******************************************************************/
 
 #include <iostream>
+#include <algorithm>
 
 #include <util/options.h>
 #include <util/i2string.h>
@@ -16,6 +17,7 @@ Author: Peter Schrammel
 #include <goto-programs/write_goto_binary.h>
 
 #include <solvers/sat/satcheck.h>
+#include <solvers/sat/cnf.h>
 #include <solvers/flattening/bv_pointers.h>
 #include <solvers/prop/literal_expr.h>
 
@@ -23,6 +25,8 @@ Author: Peter Schrammel
 #include "../ssa/simplify_ssa.h"
 #include "../ssa/ssa_build_goto_trace.h"
 #include "../domains/ssa_analyzer.h"
+#include "../domains/lazy_message.h"
+#include "../domains/profiling.h"
 #include "../ssa/ssa_unwinder.h"
 #include <cstdlib>
 
@@ -54,11 +58,15 @@ Function: summary_checker_baset::SSA_functions
 
 void summary_checker_baset::SSA_functions(const goto_modelt &goto_model,  const namespacet &ns)
 {  
+  profile_scopet profile_scope("ssa");
+
   // compute SSA for all the functions
   forall_goto_functions(f_it, goto_model.goto_functions)
   {
     if(!f_it->second.body_available()) continue;
     if(has_prefix(id2string(f_it->first),TEMPLATE_DECL)) continue;
+    // kept from a previous run (see reload)
+    if(ssa_db.exists(f_it->first)) continue;
     status() << "Computing SSA of " << f_it->first << messaget::eom;
     
     ssa_db.create(f_it->first, f_it->second, ns);
@@ -71,7 +79,10 @@ void summary_checker_baset::SSA_functions(const goto_modelt &goto_model,  const
       ::simplify(SSA, ns);
     }
 
-    SSA.output(debug()); debug() << eom;
+    if(message_enabled(*this,M_DEBUG))
+    {
+      SSA.output(debug()); debug() << eom;
+    }
   }
 
   // properties
@@ -129,6 +140,8 @@ void summary_checker_baset::summarize(const goto_modelt &goto_model,
   solver_instances += summarizer->get_number_of_solver_instances();
   solver_calls += summarizer->get_number_of_solver_calls();
   summaries_used += summarizer->get_number_of_summaries_used();
+  strategy_iterations += summarizer->get_number_of_strategy_iterations();
+  reused_invariant_rows += summarizer->get_number_of_reused_invariant_rows();
 
   delete summarizer;
 }
@@ -195,17 +208,22 @@ Function: summary_checker_baset::check_properties
 void summary_checker_baset::check_properties(
    const ssa_dbt::functionst::const_iterator f_it)
 {
+  profile_scopet profile_scope("property checking", f_it->first);
   unwindable_local_SSAt &SSA = *f_it->second;
   
   bool all_properties = options.get_bool_option("all-properties");
 
-  SSA.output_verbose(debug()); debug() << eom;
+  if(message_enabled(*this,M_DEBUG))
+  {
+    SSA.output_verbose(debug()); debug() << eom;
+  }
   
   // incremental version
 
   // solver
   incremental_solvert &solver = ssa_db.get_solver(f_it->first);
   solver.set_message_handler(get_message_handler());
+  solver.collect_garbage();
 
   // give SSA to solver
   solver << SSA;
@@ -236,6 +254,8 @@ void summary_checker_baset::check_properties(
     is_fully_unwound(loop_continues,loophead_selects,solver);
   status() << "Loops " << (fully_unwound ? "" : "not ") 
 	   << "fully unwound" << eom;
+  if(!fully_unwound)
+    update_exhausted_loops(f_it->first,loophead_selects,solver);
 
   cover_goals_extt cover_goals(
     SSA,solver,loophead_selects,property_map,
@@ -318,6 +338,8 @@ void summary_checker_baset::check_properties(
 
   cover_goals();  
 
+  cover_goals.build_error_traces();
+
   //set all non-covered goals to PASS except if we do not try 
   //  to cover all goals and we have found a FAIL
   if(all_properties || cover_goals.number_covered()==0) 
@@ -361,17 +383,110 @@ void summary_checker_baset::report_statistics()
     unsigned calls = solver.get_number_of_solver_calls();
     if(calls>0) solver_instances++;
     solver_calls += calls;
+    solver_rebuilds += solver.get_number_of_rebuilds();
+    reclaimed_clauses += solver.get_reclaimed_clauses();
+    shared_domains += solver.get_number_of_shared_domains();
+
+    if(profiler.enabled)
+    {
+      const std::string &function=id2string(f_it->first);
+      profiler.set_function_stat(function, "solver calls", calls);
+      profiler.set_function_stat(function, "solver time",
+                                 solver.get_solver_time());
+      profiler.set_function_stat(function, "solver rebuilds",
+                                 solver.get_number_of_rebuilds());
+      profiler.set_function_stat(function, "shared templates",
+                                 solver.get_number_of_shared_domains());
+      profiler.set_function_stat(function, "variables",
+                                 solver.sat_check->no_variables());
+      const cnf_solvert *cnf=dynamic_cast<const cnf_solvert *>(solver.sat_check);
+      if(cnf!=NULL)
+        profiler.set_function_stat(function, "clauses", cnf->no_clauses());
+    }
   }
   statistics() << "** statistics: " << eom;
   statistics() << "  number of solver instances: " << solver_instances << eom;
   statistics() << "  number of solver calls: " << solver_calls << eom;
   statistics() << "  number of summaries used: " 
                << summaries_used << eom;
+  statistics() << "  number of strategy iterations: " 
+               << strategy_iterations << eom;
+  if(reused_invariant_rows>0)
+    statistics() << "  number of reused invariant rows: " 
+                 << reused_invariant_rows << eom;
+  if(shared_domains>0)
+    statistics() << "  number of shared template encodings: "
+                 << shared_domains << eom;
+  if(solver_rebuilds>0)
+    statistics() << "  number of solver rebuilds: " << solver_rebuilds
+                 << " (" << reclaimed_clauses << " clauses reclaimed)" << eom;
+  if(unwinding_rounds>0)
+  {
+    statistics() << "  number of unwinding rounds: " << unwinding_rounds
+                 << " (linear schedule: " << final_unwinding+1 << ")" << eom;
+    if(narrowing_rounds>0)
+      statistics() << "  number of narrowing rounds: " 
+                   << narrowing_rounds << eom;
+  }
   statistics() << eom;
 }
   
 /*******************************************************************\
 
+Function: summary_checker_baset::narrow_failing_depth
+
+  Inputs: lower: smallest depth not yet checked
+          upper: depth at which a property fails
+
+ Outputs: minimal failing depth
+
+ Purpose: binary search with checkers that unwind directly
+          to the probed depth; the property map of the 
+          minimal failing depth is taken over, unless
+          all properties are checked
+
+\*******************************************************************/
+
+unsigned summary_checker_baset::narrow_failing_depth(
+  const goto_modelt &goto_model, unsigned lower, unsigned upper)
+{
+  status() << "Narrowing failing depth between " << lower 
+           << " and " << upper << eom;
+
+  null_message_handlert null_message_handler;
+  while(lower<upper)
+  {
+    unsigned middle = lower+(upper-lower)/2;
+
+    optionst probe_options(options);
+    probe_options.set_option("unwind", middle);
+    probe_options.set_option("unwind-schedule", i2string(middle));
+    summary_checker_baset *probe = new_probe(probe_options);
+    if(probe==NULL)
+      break;
+    probe->set_message_handler(null_message_handler);
+    probe->simplify = simplify;
+    probe->fixed_point = fixed_point;
+    probe->narrowing = false;
+
+    narrowing_rounds++;
+    if((*probe)(goto_model)==FAIL)
+    {
+      upper = middle;
+      if(!options.get_bool_option("all-properties"))
+        property_map = probe->property_map;
+    }
+    else
+      lower = middle+1;
+
+    solver_calls += probe->solver_calls;
+    delete probe;
+  }
+  return upper;
+}
+
+/*******************************************************************\
+
 Function: summary_checker_baset::do_show_vcc
 
   Inputs:
@@ -530,6 +645,53 @@ bool summary_checker_baset::is_fully_unwound(
 
 /*******************************************************************\
 
+Function: summary_checker_baset::update_exhausted_loops
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: tells the unwinder which loops cannot continue any more,
+          such that only the others are unwound further
+
+\*******************************************************************/
+
+void summary_checker_baset::update_exhausted_loops(
+  const irep_idt &function_name,
+  const exprt::operandst &loophead_selects,
+  incremental_solvert &solver)
+{
+  ssa_local_unwindert &unwinder = ssa_unwinder.get(function_name);
+  //with a single loop, there is nothing to choose
+  if(unwinder.number_of_loops()<2) 
+    return;
+
+  ssa_local_unwindert::loop_continuest loop_conts;
+  unwinder.loop_continuation_conditions(loop_conts);
+  for(ssa_local_unwindert::loop_continuest::const_iterator 
+	it = loop_conts.begin(); it != loop_conts.end(); ++it)
+  {
+    solver.new_context();
+    solver << and_exprt(conjunction(loophead_selects),
+			disjunction(it->second));
+
+    solver_calls++; //statistics
+
+    decision_proceduret::resultt result = solver();
+    solver.pop_context();
+    if(result==decision_proceduret::D_ERROR)
+      throw "error from decision procedure";
+
+    bool exhausted = (result==decision_proceduret::D_UNSATISFIABLE);
+    unwinder.set_exhausted(it->first,exhausted);
+    if(exhausted)
+      debug() << "Loop " << it->first << " in " << function_name 
+	      << " exhausted" << eom;
+  }
+}
+
+/*******************************************************************\
+
 Function: summary_checker_baset::is_spurious
 
   Inputs:
@@ -600,3 +762,262 @@ void summary_checker_baset::instrument_and_output(goto_modelt &goto_model)
 		    goto_model.symbol_table, 
 		    goto_model.goto_functions, get_message_handler());
 }
+
+/*******************************************************************\
+
+Function: is_global_symbol
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: types and variables with static lifetime
+
+\*******************************************************************/
+
+static bool is_global_symbol(const symbolt &symbol)
+{
+  return symbol.is_type || symbol.is_static_lifetime;
+}
+
+/*******************************************************************\
+
+Function: same_global_symbols
+
+  Inputs:
+
+ Outputs: true if both symbol tables have the same types
+          and static variables
+
+ Purpose:
+
+\*******************************************************************/
+
+static bool same_global_symbols(
+  const symbol_tablet &symbol_table1,
+  const symbol_tablet &symbol_table2)
+{
+  unsigned globals1=0, globals2=0;
+  forall_symbols(it, symbol_table1.symbols)
+  {
+    if(!is_global_symbol(it->second))
+      continue;
+    globals1++;
+    symbol_tablet::symbolst::const_iterator s_it=
+      symbol_table2.symbols.find(it->first);
+    if(s_it==symbol_table2.symbols.end() ||
+       !is_global_symbol(s_it->second) ||
+       s_it->second.type!=it->second.type ||
+       s_it->second.value!=it->second.value)
+      return false;
+  }
+  forall_symbols(it, symbol_table2.symbols)
+    if(is_global_symbol(it->second))
+      globals2++;
+  return globals1==globals2;
+}
+
+/*******************************************************************\
+
+Function: same_function
+
+  Inputs:
+
+ Outputs: true if the functions have the same signature and
+          the same instructions at the same source locations
+
+ Purpose:
+
+\*******************************************************************/
+
+static bool same_function(
+  const goto_functionst::goto_functiont &function1,
+  const goto_functionst::goto_functiont &function2)
+{
+  if(function1.type!=function2.type ||
+     function1.body_available()!=function2.body_available())
+    return false;
+
+  const goto_programt::instructionst &instructions1=
+    function1.body.instructions;
+  const goto_programt::instructionst &instructions2=
+    function2.body.instructions;
+  if(instructions1.size()!=instructions2.size())
+    return false;
+  if(instructions1.empty())
+    return true;
+
+  // the targets are compared relative to the first instruction
+  unsigned base1=instructions1.front().location_number;
+  unsigned base2=instructions2.front().location_number;
+
+  goto_programt::instructionst::const_iterator i_it2=
+    instructions2.begin();
+  for(goto_programt::instructionst::const_iterator i_it1=
+        instructions1.begin();
+      i_it1!=instructions1.end();
+      i_it1++, i_it2++)
+  {
+    if(i_it1->type!=i_it2->type ||
+       i_it1->code!=i_it2->code ||
+       i_it1->guard!=i_it2->guard ||
+       i_it1->function!=i_it2->function ||
+       i_it1->source_location!=i_it2->source_location ||
+       i_it1->targets.size()!=i_it2->targets.size())
+      return false;
+
+    goto_programt::targetst::const_iterator t_it2=i_it2->targets.begin();
+    for(goto_programt::targetst::const_iterator t_it1=
+          i_it1->targets.begin();
+        t_it1!=i_it1->targets.end();
+        t_it1++, t_it2++)
+    {
+      if((*t_it1)->location_number-base1!=(*t_it2)->location_number-base2)
+        return false;
+    }
+  }
+  return true;
+}
+
+/*******************************************************************\
+
+Function: summary_checker_baset::can_reload
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: the unwinding modifies the SSA, which then
+          cannot be reused by the next run
+
+\*******************************************************************/
+
+bool summary_checker_baset::can_reload() const
+{
+  return !options.get_bool_option("k-induction") &&
+    !options.get_bool_option("incremental-bmc") &&
+    options.get_unsigned_int_option("unwind")==0;
+}
+
+/*******************************************************************\
+
+Function: summary_checker_baset::reload
+
+  Inputs: the analysed goto model and a freshly read one
+
+ Outputs: the number of functions whose SSA has been kept
+
+ Purpose: takes over new_model into goto_model such that the next
+          run only recomputes what has changed: 
+          the bodies of unchanged functions are kept (the SSA 
+          refers to them) together with their SSA and summaries;
+          changed functions get a new SSA; 
+          they and their (transitive) callers get new summaries.
+          If types or globals have changed, nothing is kept.
+
+\*******************************************************************/
+
+unsigned summary_checker_baset::reload(
+  goto_modelt &goto_model,
+  goto_modelt &new_model)
+{
+  assert(can_reload());
+
+  goto_functionst::function_mapt &functions=
+    goto_model.goto_functions.function_map;
+  goto_functionst::function_mapt &new_functions=
+    new_model.goto_functions.function_map;
+
+  bool same_globals=same_global_symbols(
+    goto_model.symbol_table, new_model.symbol_table);
+
+  // removed functions
+  std::set<irep_idt> changed;
+  forall_goto_functions(f_it, goto_model.goto_functions)
+  {
+    if(!same_globals || new_functions.find(f_it->first)==new_functions.end())
+      changed.insert(f_it->first);
+  }
+
+  // added and modified functions
+  forall_goto_functions(f_it, new_model.goto_functions)
+  {
+    goto_functionst::function_mapt::const_iterator old_it=
+      functions.find(f_it->first);
+    if(!same_globals || old_it==functions.end() || 
+       !same_function(old_it->second, f_it->second))
+      changed.insert(f_it->first);
+  }
+
+  // callers of changed functions need new summaries
+  std::set<irep_idt> recompute=changed;
+  bool progress=true;
+  while(progress)
+  {
+    progress=false;
+    forall_goto_functions(f_it, new_model.goto_functions)
+    {
+      if(recompute.find(f_it->first)!=recompute.end())
+        continue;
+      forall_goto_program_instructions(i_it, f_it->second.body)
+      {
+        if(!i_it->is_function_call())
+          continue;
+        const exprt &function=to_code_function_call(i_it->code).function();
+        if(function.id()==ID_symbol &&
+           recompute.find(to_symbol_expr(function).get_identifier())!=
+             recompute.end())
+        {
+          recompute.insert(f_it->first);
+          progress=true;
+          break;
+        }
+      }
+    }
+  }
+
+  // drop the state
+  for(std::set<irep_idt>::const_iterator it=changed.begin();
+      it!=changed.end(); it++)
+  {
+    ssa_unwinder.erase(*it);
+    ssa_db.erase(*it);
+  }
+  for(std::set<irep_idt>::const_iterator it=recompute.begin();
+      it!=recompute.end(); it++)
+    summary_db.erase(*it);
+  // the calling contexts may have changed
+  if(options.get_bool_option("context-sensitive"))
+    summary_db.mark_recompute_all();
+  // the solvers would receive the kept SSAs a second time
+  ssa_db.clear_solvers();
+  property_map.clear();
+
+  // the location numbers of the new bodies follow the kept ones
+  unsigned location_number=0;
+  forall_goto_functions(f_it, goto_model.goto_functions)
+  {
+    if(changed.find(f_it->first)==changed.end() &&
+       !f_it->second.body.instructions.empty())
+      location_number=std::max(location_number,
+        f_it->second.body.instructions.back().location_number+1);
+  }
+
+  // take over the new program
+  for(std::set<irep_idt>::const_iterator it=changed.begin();
+      it!=changed.end(); it++)
+  {
+    goto_functionst::function_mapt::iterator f_it=new_functions.find(*it);
+    if(f_it==new_functions.end())
+      functions.erase(*it);
+    else
+    {
+      goto_functionst::goto_functiont &function=functions[*it];
+      function.swap(f_it->second);
+      function.body.compute_location_numbers(location_number);
+    }
+  }
+  goto_model.symbol_table.swap(new_model.symbol_table);
+
+  return ssa_db.functions().size();
+}
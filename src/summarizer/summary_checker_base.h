@@ -29,22 +29,46 @@ public:
     show_vcc(false),
     simplify(false),
     fixed_point(false),
+    narrowing(true),
     options(_options),
     ssa_db(_options),summary_db(),
     ssa_unwinder(ssa_db),
     ssa_inliner(summary_db),
     solver_instances(0),
     solver_calls(0),
-    summaries_used(0)
+    summaries_used(0),
+    unwinding_rounds(0),
+    narrowing_rounds(0),
+    final_unwinding(0),
+    solver_rebuilds(0),
+    reclaimed_clauses(0),
+    shared_domains(0),
+    strategy_iterations(0),
+    reused_invariant_rows(0)
   {
-    ssa_inliner.set_message_handler(get_message_handler());
+    summary_db.set_max_summary_size(
+      options.get_unsigned_int_option("max-summary-size"));
+    ssa_unwinder.set_unwindset(options.get_option("unwindset"));
   }
   
   bool show_vcc, simplify, fixed_point;
+  bool narrowing; // search the minimal failing depth after a jump in k
   irep_idt function_to_check;
 
   virtual resultt operator()(const goto_modelt &) { assert(false); }
 
+  virtual void set_message_handler(message_handlert &handler)
+  {
+    messaget::set_message_handler(handler);
+    ssa_inliner.set_message_handler(handler);
+  }
+
+  const summary_dbt &get_summary_db() const { return summary_db; }
+
+  // incremental re-analysis of a modified program (server mode)
+  bool can_reload() const;
+  unsigned reload(goto_modelt &goto_model, goto_modelt &new_model);
+
   void instrument_and_output(goto_modelt &goto_model);
 
   // statistics
@@ -62,8 +86,19 @@ protected:
   unsigned solver_instances;
   unsigned solver_calls;
   unsigned summaries_used;
+  unsigned unwinding_rounds, narrowing_rounds, final_unwinding;
+  unsigned solver_rebuilds;
+  unsigned long reclaimed_clauses;
+  unsigned shared_domains;
+  unsigned strategy_iterations;
+  unsigned reused_invariant_rows;
   void report_statistics();
 
+  // checker for a single unwinding depth used by the narrowing search
+  virtual summary_checker_baset *new_probe(optionst &) { return NULL; }
+  unsigned narrow_failing_depth(
+    const goto_modelt &goto_model, unsigned lower, unsigned upper);
+
   void do_show_vcc(
     const local_SSAt &,
     const goto_programt::const_targett,
@@ -88,6 +123,10 @@ protected:
     const exprt::operandst& loop_continues,
     const exprt::operandst& loophead_selects, 
     incremental_solvert&);
+  void update_exhausted_loops(
+    const irep_idt &function_name,
+    const exprt::operandst& loophead_selects, 
+    incremental_solvert&);
 };
 
 #endif
@@ -7,6 +7,7 @@ Author: Peter Schrammel
 \*******************************************************************/
 
 #include "summary_checker_bmc.h"
+#include "unwind_schedule.h"
 
 
 /*******************************************************************\
@@ -35,7 +36,9 @@ property_checkert::resultt summary_checker_bmct::operator()(
   status() << "Max-unwind is " << max_unwind << eom;
   ssa_unwinder.init_localunwinders();
 
-  for(unsigned unwind = 0; unwind<=max_unwind; unwind++)
+  unwind_schedulet schedule(options.get_option("unwind-schedule"),max_unwind);
+  unsigned unwind = 0, previous_unwind = 0;
+  while(schedule.next(unwind))
   {
     status() << "Unwinding (k=" << unwind << ")" << messaget::eom;
     summary_db.mark_recompute_all();
@@ -49,11 +52,23 @@ property_checkert::resultt summary_checker_bmct::operator()(
     }
     else if(result == property_checkert::FAIL) 
     {
+      unsigned lower = schedule.get_rounds()>1 ? previous_unwind+1 : 0;
+      if(narrowing && lower<unwind)
+        unwind = narrow_failing_depth(goto_model,lower,unwind);
       status() << "incremental BMC counterexample found after " 
 	       << unwind << " unwinding(s)" << messaget::eom;
       break;
     }
+    else if(ssa_unwinder.is_bounded(unwind))
+    {
+      status() << "all loops unwound to their bounds after "
+	       << unwind << " unwinding(s)" << messaget::eom;
+      break;
+    }
+    previous_unwind = unwind;
   }
+  unwinding_rounds = schedule.get_rounds();
+  final_unwinding = unwind;
   report_statistics();
   return result;
 }
@@ -21,6 +21,10 @@ public:
   
   virtual resultt operator()(const goto_modelt &);
 
+protected:
+  virtual summary_checker_baset *new_probe(optionst &_options)
+    { return new summary_checker_bmct(_options); }
+
 };
 
 #endif
@@ -0,0 +1,349 @@
+/*******************************************************************\
+
+Module: Summary Checker for k-induction and incremental BMC
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#include <sstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#endif
+
+#include <util/options.h>
+#include <util/message.h>
+
+#include "summary_checker_kind.h"
+#include "summary_checker_kiki.h"
+#include "unwind_schedule.h"
+
+/*******************************************************************\
+
+Function: summary_checker_kikit::operator()
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: incremental BMC is run in this process, k-induction
+          in a child process (the expression data structures
+          are not thread-safe); the results of k-induction are
+          picked up between the BMC unwindings
+
+\*******************************************************************/
+
+property_checkert::resultt summary_checker_kikit::operator()(
+  const goto_modelt &goto_model)
+{
+  start_kind(goto_model);
+
+  const namespacet ns(goto_model.symbol_table);
+
+  SSA_functions(goto_model,ns);
+
+  ssa_unwinder.init(false,true);
+
+  property_checkert::resultt result = property_checkert::UNKNOWN;
+  unsigned max_unwind = options.get_unsigned_int_option("unwind");
+  status() << "Max-unwind is " << max_unwind << eom;
+  ssa_unwinder.init_localunwinders();
+
+  unwind_schedulet schedule(options.get_option("unwind-schedule"),max_unwind);
+  unsigned unwind = 0, previous_unwind = 0;
+  while(schedule.next(unwind))
+  {
+    if(poll_kind(false))
+    {
+      merge_kind_results();
+      result = get_result();
+      if(result != property_checkert::UNKNOWN)
+      {
+        status() << "k-induction result used after "
+                 << unwind << " BMC unwinding(s)" << eom;
+        break;
+      }
+    }
+
+    status() << "Unwinding (k=" << unwind << ")" << messaget::eom;
+    summary_db.mark_recompute_all();
+    ssa_unwinder.unwind_all(unwind);
+    result =  check_properties();
+    if(result == property_checkert::PASS)
+    {
+      status() << "incremental BMC proof found after "
+	       << unwind << " unwinding(s)" << messaget::eom;
+      break;
+    }
+    else if(result == property_checkert::FAIL)
+    {
+      unsigned lower = schedule.get_rounds()>1 ? previous_unwind+1 : 0;
+      if(narrowing && lower<unwind)
+        unwind = narrow_failing_depth(goto_model,lower,unwind);
+      status() << "incremental BMC counterexample found after "
+	       << unwind << " unwinding(s)" << messaget::eom;
+      break;
+    }
+    else if(ssa_unwinder.is_bounded(unwind))
+    {
+      status() << "all loops unwound to their bounds after "
+	       << unwind << " unwinding(s)" << messaget::eom;
+      break;
+    }
+    previous_unwind = unwind;
+  }
+  unwinding_rounds = schedule.get_rounds();
+  final_unwinding = unwind;
+
+  // BMC has given up, k-induction may still succeed
+  if(result == property_checkert::UNKNOWN && poll_kind(true))
+  {
+    merge_kind_results();
+    result = get_result();
+  }
+
+  stop_kind();
+  report_statistics();
+  return result;
+}
+
+/*******************************************************************\
+
+Function: summary_checker_kikit::start_kind
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: forks the k-induction process, which writes
+          one line "<result> <property id>" per property
+
+\*******************************************************************/
+
+void summary_checker_kikit::start_kind(const goto_modelt &goto_model)
+{
+#ifndef _WIN32
+  int fds[2];
+  if(pipe(fds)!=0)
+  {
+    warning() << "cannot create pipe, running incremental BMC only" << eom;
+    return;
+  }
+
+  std::cout.flush();
+  std::cerr.flush();
+
+  pid_t pid=fork();
+  if(pid==0) // child
+  {
+    close(fds[0]);
+    int status=0;
+    try
+    {
+      // incremental BMC havocs loops, k-induction must not
+      options.set_option("havoc", false);
+
+      // the results are only reported through the pipe;
+      //   output would interleave with that of incremental BMC
+      null_message_handlert null_message_handler;
+      summary_checker_kindt summary_checker_kind(options);
+      summary_checker_kind.set_message_handler(null_message_handler);
+      summary_checker_kind.simplify=simplify;
+      summary_checker_kind.fixed_point=fixed_point;
+      summary_checker_kind(goto_model);
+
+      std::ostringstream out;
+      for(property_mapt::const_iterator
+          p_it=summary_checker_kind.property_map.begin();
+          p_it!=summary_checker_kind.property_map.end(); p_it++)
+      {
+        if(p_it->first=="") continue;
+        out << (p_it->second.result==PASS ? "PASS" :
+                p_it->second.result==FAIL ? "FAIL" : "UNKNOWN")
+            << " " << p_it->first << "\n";
+      }
+
+      const std::string &s=out.str();
+      const char *data=s.c_str();
+      size_t size=s.size();
+      while(size>0)
+      {
+        ssize_t written=write(fds[1], data, size);
+        if(written<=0) { status=1; break; }
+        data+=written;
+        size-=written;
+      }
+    }
+    catch(...)
+    {
+      status=1;
+    }
+    close(fds[1]);
+    _exit(status);
+  }
+  close(fds[1]);
+  if(pid<0) // could not fork
+  {
+    close(fds[0]);
+    warning() << "cannot fork, running incremental BMC only" << eom;
+    return;
+  }
+
+  kind_pid=pid;
+  kind_fd=fds[0];
+#endif
+}
+
+/*******************************************************************\
+
+Function: summary_checker_kikit::poll_kind
+
+  Inputs: wait: block until the k-induction process has finished
+
+ Outputs: true if the k-induction results are available
+
+ Purpose:
+
+\*******************************************************************/
+
+bool summary_checker_kikit::poll_kind(bool wait)
+{
+#ifdef _WIN32
+  return false;
+#else
+  if(kind_fd<0)
+    return false;
+
+  while(true)
+  {
+    struct pollfd p;
+    p.fd=kind_fd;
+    p.events=POLLIN;
+    p.revents=0;
+    if(poll(&p, 1, wait ? -1 : 0)<=0)
+      return false; // nothing there yet
+
+    char buffer[4096];
+    ssize_t r=read(kind_fd, buffer, sizeof(buffer));
+    if(r<=0) // end of file: k-induction has finished
+    {
+      close(kind_fd);
+      kind_fd=-1;
+      int status;
+      waitpid(kind_pid, &status, 0);
+      kind_pid=-1;
+      if(!WIFEXITED(status) || WEXITSTATUS(status)!=0)
+      {
+        warning() << "k-induction process failed" << eom;
+        kind_output.clear();
+      }
+      return true;
+    }
+    kind_output.append(buffer, r);
+  }
+#endif
+}
+
+/*******************************************************************\
+
+Function: summary_checker_kikit::stop_kind
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+void summary_checker_kikit::stop_kind()
+{
+#ifndef _WIN32
+  if(kind_fd>=0)
+  {
+    close(kind_fd);
+    kind_fd=-1;
+  }
+  if(kind_pid>0)
+  {
+    kill(kind_pid, SIGKILL);
+    int status;
+    waitpid(kind_pid, &status, 0);
+    kind_pid=-1;
+  }
+#endif
+}
+
+/*******************************************************************\
+
+Function: summary_checker_kikit::merge_kind_results
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: takes the results of k-induction for the properties
+          that are still undecided; failures are only taken
+          if no error trace is requested, as the trace
+          cannot be obtained from the other process
+
+\*******************************************************************/
+
+void summary_checker_kikit::merge_kind_results()
+{
+  bool build_error_trace =
+    options.get_bool_option("show-trace") ||
+    options.get_option("graphml-cex")!="" ||
+    options.get_option("json-cex")!="";
+
+  std::istringstream in(kind_output);
+  std::string line;
+  while(std::getline(in, line))
+  {
+    std::size_t pos=line.find(' ');
+    if(pos==std::string::npos) continue;
+    std::string result=line.substr(0, pos);
+    irep_idt property_id=line.substr(pos+1);
+
+    property_mapt::iterator p_it=property_map.find(property_id);
+    if(p_it==property_map.end() || p_it->second.result!=UNKNOWN)
+      continue;
+
+    if(result=="PASS")
+      p_it->second.result=PASS;
+    else if(result=="FAIL" && !build_error_trace)
+      p_it->second.result=FAIL;
+  }
+  kind_output.clear();
+}
+
+/*******************************************************************\
+
+Function: summary_checker_kikit::get_result
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+property_checkert::resultt summary_checker_kikit::get_result() const
+{
+  resultt result = PASS;
+  for(property_mapt::const_iterator
+      p_it=property_map.begin(); p_it!=property_map.end(); p_it++)
+  {
+    if(p_it->second.result==FAIL)
+      return FAIL;
+    if(p_it->second.result==UNKNOWN)
+      result = UNKNOWN;
+  }
+  return result;
+}
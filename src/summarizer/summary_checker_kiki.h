@@ -0,0 +1,48 @@
+/*******************************************************************\
+
+Module: Summary Checker for k-induction and incremental BMC
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#ifndef CPROVER_SUMMARY_CHECKER_KIKI_H
+#define CPROVER_SUMMARY_CHECKER_KIKI_H
+
+#include <string>
+
+#include "summary_checker_bmc.h"
+
+/* Runs incremental BMC and, in a separate process,
+   k-induction. The results of the k-induction process are
+   merged into the property map as soon as they are available;
+   the first definitive result for a property wins. */
+
+class summary_checker_kikit:public summary_checker_baset
+{
+public:
+  inline summary_checker_kikit(optionst &_options):
+    summary_checker_baset(_options),
+    kind_pid(-1),
+    kind_fd(-1)
+  {
+  }
+
+  virtual resultt operator()(const goto_modelt &);
+
+protected:
+  int kind_pid, kind_fd;
+  std::string kind_output;
+
+  void start_kind(const goto_modelt &goto_model);
+  bool poll_kind(bool wait);
+  void stop_kind();
+  void merge_kind_results();
+  resultt get_result() const;
+
+  // the narrowing search only needs incremental BMC
+  virtual summary_checker_baset *new_probe(optionst &_options)
+    { return new summary_checker_bmct(_options); }
+};
+
+#endif
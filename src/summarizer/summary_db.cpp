@@ -12,21 +12,53 @@ Author: Daniel Kroening, kroening@kroening.com
 
 #include "summary_db.h"
 
+/*******************************************************************\
+
+Function: summary_dbt::put
+
+  Inputs:
+
+ Outputs:
+
+ Purpose: stores the summary, or joins it with the existing one
+          if that one is not marked for recomputation
+
+\*******************************************************************/
+
 void summary_dbt::put(const function_namet &function_name, 
-		      const summaryt &summary)
+		      const summaryt &summary,
+		      const namespacet &ns)
 { 
-  if(store.find(function_name)==store.end() || 
-     store[function_name].mark_recompute)
-    store[function_name] = summary; 
+  storet::iterator it = store.find(function_name);
+  if(it==store.end())
+    store.insert(std::make_pair(function_name, summary));
+  else if(it->second.mark_recompute)
+    it->second = summary; 
   else
-    store[function_name].join(summary);
+    it->second.join(summary, max_summary_size, &ns);
+  versions[function_name]++;
 }
 
+/*******************************************************************\
+
+Function: summary_dbt::mark_recompute_all
+
+  Inputs:
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
 void summary_dbt::mark_recompute_all()
 {
-  for(std::map<function_namet, summaryt>::iterator it = store.begin();
+  for(storet::iterator it = store.begin();
       it != store.end(); it++)
+  {
     it->second.mark_recompute = true;
+    versions[it->first]++;
+  }
 }
 
 /*******************************************************************\
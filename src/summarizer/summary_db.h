@@ -18,23 +18,57 @@ class summary_dbt:public messaget
 public:
   typedef irep_idt function_namet;
 
+  summary_dbt() : max_summary_size(0) {}
+
+  // bound on the size of joined summaries (0 for unbounded)
+  void set_max_summary_size(unsigned size) { max_summary_size=size; }
+
   // retrieve a summary for function with given identifier
   void read(const std::string &);
   void write();
+  // versions are kept such that they increase monotonically
   void clear() { store.clear(); }
 
-  summaryt get(const function_namet &function_name) const 
+  // The returned references stay valid until the next put()
+  // for the same function; the stored summaries are never copied.
+  const summaryt &get(const function_namet &function_name) const 
     { return store.at(function_name); }
+  // returns NULL if there is no summary for the function
+  const summaryt *find(const function_namet &function_name) const
+  { 
+    storet::const_iterator it=store.find(function_name);
+    return it==store.end() ? NULL : &it->second;
+  }
   bool exists(const function_namet &function_name) const  
     { return store.find(function_name)!=store.end(); }
-  void put(const function_namet &function_name, const summaryt &summary);
+  void put(const function_namet &function_name, const summaryt &summary,
+           const namespacet &ns);
+
+  // incremented whenever the summary is replaced, joined, erased
+  //  or marked for recomputation; 0 if there was none
+  unsigned get_version(const function_namet &function_name) const
+  {
+    versionst::const_iterator it=versions.find(function_name);
+    return it==versions.end() ? 0 : it->second;
+  }
 
   void mark_recompute_all();
 
+  // drops the summary such that it is recomputed
+  void erase(const function_namet &function_name)
+  {
+    if(store.erase(function_name)>0)
+      versions[function_name]++;
+  }
+
   jsont summary;
 
 protected:
-  std::map<function_namet, summaryt> store;
+  typedef std::map<function_namet, summaryt> storet;
+  storet store;
+  typedef std::map<function_namet, unsigned> versionst;
+  versionst versions;
+  unsigned max_summary_size;
 
   std::string current;
   std::string file_name(const std::string &);
@@ -0,0 +1,130 @@
+/*******************************************************************\
+
+Module: Schedules for the Unwinding in k-induction and BMC
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#include <cassert>
+#include <algorithm>
+
+#include <util/string2int.h>
+
+#include "unwind_schedule.h"
+
+/*******************************************************************\
+
+Function: unwind_schedulet::unwind_schedulet
+
+  Inputs: schedule: linear (default), geometric, luby
+                    or a comma-separated list of depths
+
+ Outputs:
+
+ Purpose:
+
+\*******************************************************************/
+
+unwind_schedulet::unwind_schedulet(
+  const std::string &schedule,
+  unsigned _max_unwind):
+  max_unwind(_max_unwind),
+  rounds(0),
+  current(0)
+{
+  if(schedule=="" || schedule=="linear")
+    kind=LINEAR;
+  else if(schedule=="geometric")
+    kind=GEOMETRIC;
+  else if(schedule=="luby")
+    kind=LUBY;
+  else
+  {
+    kind=LIST;
+    std::string::size_type start=0;
+    while(start<schedule.size())
+    {
+      std::string::size_type end=schedule.find(',', start);
+      if(end==std::string::npos) end=schedule.size();
+      std::string depth=schedule.substr(start, end-start);
+      start=end+1;
+      if(depth.empty() ||
+         depth.find_first_not_of("0123456789")!=std::string::npos)
+        throw "unknown unwind schedule `"+schedule+"'";
+      depths.push_back(unsafe_string2unsigned(depth));
+    }
+    std::sort(depths.begin(), depths.end());
+    depths.erase(std::unique(depths.begin(), depths.end()), depths.end());
+  }
+}
+
+/*******************************************************************\
+
+Function: unwind_schedulet::luby
+
+  Inputs: i>=1
+
+ Outputs: i-th element of the Luby sequence
+
+ Purpose:
+
+\*******************************************************************/
+
+unsigned unwind_schedulet::luby(unsigned i)
+{
+  // find k such that 2^(k-1) <= i < 2^k
+  unsigned power=1;
+  while(2*power<=i) power*=2;
+  if(i==2*power-1)
+    return power;
+  return luby(i-power+1);
+}
+
+/*******************************************************************\
+
+Function: unwind_schedulet::next
+
+  Inputs:
+
+ Outputs: k: the next depth
+
+ Purpose:
+
+\*******************************************************************/
+
+bool unwind_schedulet::next(unsigned &k)
+{
+  unsigned candidate;
+  if(kind==LIST)
+  {
+    if(rounds>=depths.size())
+      return false;
+    candidate=depths[rounds];
+  }
+  else if(rounds==0)
+    candidate=0;
+  else
+  {
+    unsigned step=0;
+    switch(kind)
+    {
+    case LINEAR: step=1; break;
+    case GEOMETRIC: step=current==0 ? 1 : current; break;
+    case LUBY: step=luby(rounds); break;
+    default: assert(false);
+    }
+    candidate=current+step;
+    if(candidate<current) candidate=max_unwind; // overflow
+  }
+
+  if(rounds>0 && current>=max_unwind)
+    return false;
+  if(candidate>max_unwind)
+    candidate=max_unwind;
+
+  current=candidate;
+  rounds++;
+  k=current;
+  return true;
+}
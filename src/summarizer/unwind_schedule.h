@@ -0,0 +1,46 @@
+/*******************************************************************\
+
+Module: Schedules for the Unwinding in k-induction and BMC
+
+Author: Peter Schrammel
+
+\*******************************************************************/
+
+#ifndef CPROVER_SUMMARIZER_UNWIND_SCHEDULE_H
+#define CPROVER_SUMMARIZER_UNWIND_SCHEDULE_H
+
+#include <string>
+#include <vector>
+
+/* Yields the unwinding depths to be checked:
+     linear:    0,1,2,3,...
+     geometric: 0,1,2,4,8,...
+     luby:      0 and then increments following the Luby sequence
+                1,1,2,1,1,2,4,...
+     k1,k2,...: the given depths
+   Depths never exceed the maximum unwinding. The linear,
+   geometric and luby schedules end with the maximum unwinding,
+   a list ends with its largest depth. */
+
+class unwind_schedulet
+{
+public:
+  unwind_schedulet(const std::string &schedule, unsigned _max_unwind);
+
+  // false if the schedule is exhausted
+  bool next(unsigned &k);
+
+  unsigned get_rounds() const { return rounds; }
+
+protected:
+  typedef enum { LINEAR, GEOMETRIC, LUBY, LIST } kindt;
+  kindt kind;
+  unsigned max_unwind;
+  unsigned rounds;
+  unsigned current;
+  std::vector<unsigned> depths;
+
+  static unsigned luby(unsigned i);
+};
+
+#endif